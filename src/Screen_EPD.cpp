@@ -54,14 +54,76 @@
 // Release 1005: Added support for EXT3.2
 // Release 1007: Improved stability
 // Release 1008: Added support for 290-QS-0F
+// Release 1009: Added pixel kernels per frame-buffer layout
+// Release 1009: Added spans with byte runs
+// Release 1009: Added block fill for solid rectangles
+// Release 1009: Added skip of identical frames for fast update
+// Release 1009: Added swap of next and previous frame-buffers for fast update
+// Release 1009: Added copy of stale lines only from previous frame-buffer
+// Release 1009: Added ordered dithering for other colours
+// Release 1009: Added bitmaps with aligned bytes
+// Release 1009: Added read of pixel and operations on area
+// Release 1009: Added copy and scroll of area
+// Release 1009: Added glyph cache for text
+// Release 1009: Added glyphs of proportional width to cache
+// Release 1009: Added point without check for clipped primitives
+// Release 1009: Added clip rectangle to points, spans, areas, bitmaps and glyphs
+// Release 1009: Added banded rendering with render and output functions
+// Release 1009: Added replay of display list for banded rendering
+// Release 1009: Added frame-buffer supplied by the caller and end()
+// Release 1009: Added external memory for frame-buffer with cache of lines
+// Release 1009: Added monochrome mode with single page for normal update, zero page set by ZERO_PAGE_SIZE
 //
 
 // Library header
 #include "Screen_EPD.h"
 
+// Allocation without exception
+#include <new>
+
 // Screens table
 #include "Screen_EPD_Table.h"
 
+// Palettes for dithering, physical code and red, green, blue
+static const uint8_t paletteBW[][4] =
+{
+    { 0b0, 0xff, 0xff, 0xff }, // white
+    { 0b1, 0x00, 0x00, 0x00 }, // black
+};
+
+static const uint8_t paletteBWR[][4] =
+{
+    { 0b00, 0xff, 0xff, 0xff }, // white
+    { 0b01, 0x00, 0x00, 0x00 }, // black
+    { 0b10, 0xff, 0x00, 0x00 }, // red
+};
+
+static const uint8_t paletteBWRY[][4] =
+{
+    { 0b00, 0x00, 0x00, 0x00 }, // black
+    { 0b01, 0xff, 0xff, 0xff }, // white
+    { 0b10, 0xff, 0xff, 0x00 }, // yellow
+    { 0b11, 0xff, 0x00, 0x00 }, // red
+};
+
+// Bayer matrix 8x8, top-left 4x4 >> 2 and 2x2 >> 4 give smaller matrices
+static const uint8_t bayer8x8[8][8] =
+{
+    {  0, 32,  8, 40,  2, 34, 10, 42 },
+    { 48, 16, 56, 24, 50, 18, 58, 26 },
+    { 12, 44,  4, 36, 14, 46,  6, 38 },
+    { 60, 28, 52, 20, 62, 30, 54, 22 },
+    {  3, 35, 11, 43,  1, 33,  9, 41 },
+    { 51, 19, 59, 27, 49, 17, 57, 25 },
+    { 15, 47,  7, 39, 13, 45,  5, 37 },
+    { 63, 31, 55, 23, 61, 29, 53, 21 },
+};
+
+#if (ZERO_PAGE_SIZE > 0)
+// Second page for monochrome mode, no red
+static const uint8_t zeroPage[ZERO_PAGE_SIZE] = { 0x00 };
+#endif // ZERO_PAGE_SIZE
+
 //
 // === Class section
 //
@@ -70,9 +132,63 @@ Screen_EPD::Screen_EPD(Driver_EPD_Virtual * driver)
     s_driver = driver;
     // b_pin = driver->u_board;
     s_newImage = 0; // nullptr
+    u_newFrameBuffer = 0; // nullptr
+    u_frameBufferSize = 0;
+    u_frameBufferOwner = false;
+    u_layout = 0; // set by begin()
+    u_monochrome = false;
+    u_ditherSize = DITHER_NONE;
+    u_glyphCache = 0; // nullptr
+    u_glyphFont = 0xff; // none
+    u_glyphRows = 0;
+    u_glyphPen = false;
+    u_bandSize = 0; // whole frame-buffer
+    u_bandLines = 0;
+    u_bandFirst = 0;
+    u_bandRender = 0; // nullptr
+    u_bandOutput = 0; // nullptr
+    u_memory = 0; // nullptr
+    u_memoryLoaded = false;
+    u_memoryDirty = false;
     // COG_data[0] = 0;
 }
 
+void Screen_EPD::setBands(uint32_t bandSize, bandRender_t render, bandOutput_t output)
+{
+    // Fast update requires the previous page of the whole frame-buffer
+    uint8_t film = SCREEN_FILM(s_driver->u_eScreen_EPD);
+    if ((film == FILM_K) or (film == FILM_P))
+    {
+        hV_HAL_log(LEVEL_ERROR, "Bands not available with fast update");
+        return;
+    }
+
+    u_bandSize = bandSize;
+    u_bandRender = render;
+    u_bandOutput = output;
+}
+
+void Screen_EPD::setMonochrome(bool flag)
+{
+    u_monochrome = flag;
+}
+
+void Screen_EPD::setExternalMemory(Memory_Virtual * memory, uint32_t cacheSize, bandOutput_t output)
+{
+    // Fast update requires the previous page of the whole frame-buffer
+    uint8_t film = SCREEN_FILM(s_driver->u_eScreen_EPD);
+    if ((film == FILM_K) or (film == FILM_P))
+    {
+        hV_HAL_log(LEVEL_ERROR, "External memory not available with fast update");
+        return;
+    }
+
+    u_memory = memory;
+    u_bandSize = hV_HAL_max(cacheSize, (uint32_t)1); // at least 8 lines
+    u_bandRender = 0; // nullptr
+    u_bandOutput = output;
+}
+
 void Screen_EPD::begin()
 {
     // u_eScreen_EPD = eScreen_EPD;
@@ -199,27 +315,63 @@ void Screen_EPD::begin()
     // Actually for 1 colour; BWR requires 2 pages.
     u_pageColourSize = (uint32_t)u_bufferSizeV * (uint32_t)u_bufferSizeH;
 
+    // Groups of physical lines copied from previous frame-buffer, fast update
+    u_staleLines = (v_screenSizeV + STALE_GROUPS - 1) / STALE_GROUPS;
+    u_staleGroups = (v_screenSizeV + u_staleLines - 1) / u_staleLines;
+
+    // Pixel kernel for the frame-buffer layout
+    s_selectKernel();
+
+    // Band of physical lines, one page for next image, two for black-white-red
+    u_bandFirst = 0;
+    u_bandLines = 0;
+    if (u_bandSize > 0)
+    {
+        u_bufferDepth = (u_layout == LAYOUT_BWR) ? 2 : 1;
+        uint32_t lines = (u_bandSize / ((uint32_t)u_bufferDepth * u_bufferSizeH)) & ~0x07;
+        u_bandLines = hV_HAL_min(hV_HAL_max(lines, (uint32_t)8), (uint32_t)v_screenSizeV);
+        u_bufferSizeV = u_bandLines;
+        u_pageColourSize = (uint32_t)u_bufferSizeV * (uint32_t)u_bufferSizeH;
+    }
+
+    // Frame-buffer of a previous begin() kept if large enough
+    uint32_t frameSize = u_pageColourSize * u_bufferDepth;
+    if ((u_newFrameBuffer != 0) and (u_frameBufferSize < frameSize))
+    {
+        if (u_frameBufferOwner == false)
+        {
+            hV_HAL_log(LEVEL_ERROR, "Frame-buffer too small [%i]", frameSize);
+            s_newImage = 0; // nullptr
+            u_newFrameBuffer = 0; // nullptr
+            u_frameBufferSize = 0;
+            return;
+        }
+        s_deleteFrameBuffer();
+    }
+
     //
     // Specific SRAM section
     //
 #if defined(BOARD_HAS_PSRAM) // ESP32 PSRAM specific case
 
-    if (s_newImage == 0)
+    if (u_newFrameBuffer == 0)
     {
-        hV_HAL_log(LEVEL_DEBUG, "Create frame-buffer [%i]", u_bufferDepth * u_pageColourSize);
+        hV_HAL_log(LEVEL_DEBUG, "Create frame-buffer [%i]", frameSize);
 
-        static uint8_t * _newFrameBuffer;
-        _newFrameBuffer = (uint8_t *) ps_malloc(u_pageColourSize * u_bufferDepth);
-        s_newImage = (uint8_t *) _newFrameBuffer;
+        // Aligned on 4 bytes
+        u_newFrameBuffer = (uint8_t *) ps_malloc(frameSize);
+        u_frameBufferSize = frameSize;
+        u_frameBufferOwner = true;
     }
 
 #else // default case
 
-    if (s_newImage == 0)
+    if (u_newFrameBuffer == 0)
     {
-        static uint8_t * _newFrameBuffer;
-        _newFrameBuffer = new uint8_t[u_pageColourSize * u_bufferDepth];
-        s_newImage = (uint8_t *) _newFrameBuffer;
+        // Words, aligned on 4 bytes
+        u_newFrameBuffer = (uint8_t *) new uint32_t[(frameSize + 3) >> 2];
+        u_frameBufferSize = frameSize;
+        u_frameBufferOwner = true;
     }
 
 #endif // ESP32 BOARD_HAS_PSRAM
@@ -227,7 +379,36 @@ void Screen_EPD::begin()
     // End of Specific SRAM section
     //
 
+    if (u_newFrameBuffer == 0)
+    {
+        hV_HAL_log(LEVEL_CRITICAL, "Frame-buffer not created [%i]", frameSize);
+        hV_HAL_exit(RESULT_ERROR);
+    }
+
+    // Next and previous frame-buffers, or first and second colour pages
+    s_newImage = u_newFrameBuffer;
+    u_previousImage = u_newFrameBuffer + u_pageColourSize;
+
     memset(s_newImage, 0x00, u_pageColourSize * u_bufferDepth);
+    u_flagPrevious = false; // previous frame-buffer not yet displayed
+    u_staleCount = 0;
+
+    // External memory initialised with the empty cache
+    if (u_memory != 0)
+    {
+        for (uint16_t first = 0; first < v_screenSizeV; first += u_bandLines)
+        {
+            s_setBand(first, hV_HAL_min(u_bandLines, (uint16_t)(v_screenSizeV - first)));
+            s_transferBand(false);
+        }
+        u_memoryLoaded = true;
+        u_memoryDirty = false;
+
+        // Commands drawn one by one on the bands they cover
+        v_listImmediate = false;
+        beginList(MEMORY_COMMAND_SIZE);
+        v_listImmediate = true;
+    }
 
     setTemperatureC(25); // 25 Celsius = 77 Fahrenheit
 
@@ -303,13 +484,75 @@ void Screen_EPD::begin()
     //
 }
 
+bool Screen_EPD::begin(FRAMEBUFFER_TYPE buffer, uint32_t size)
+{
+    if ((buffer == 0) or (((uintptr_t)buffer & 0x03) != 0))
+    {
+        hV_HAL_log(LEVEL_ERROR, "Frame-buffer not aligned on 4 bytes");
+        return RESULT_ERROR;
+    }
+
+    s_deleteFrameBuffer();
+    u_newFrameBuffer = buffer;
+    u_frameBufferSize = size;
+    u_frameBufferOwner = false;
+
+    begin();
+    return (u_newFrameBuffer == 0) ? RESULT_ERROR : RESULT_SUCCESS;
+}
+
+void Screen_EPD::end()
+{
+    u_memoryLoaded = false;
+    v_listImmediate = false;
+    s_deleteFrameBuffer();
+    s_newImage = 0; // nullptr
+    u_previousImage = 0; // nullptr
+
+    delete[] u_glyphCache;
+    u_glyphCache = 0; // nullptr
+    u_glyphRows = 0;
+    u_glyphFont = 0xff; // none
+
+    deleteList();
+}
+
+void Screen_EPD::s_deleteFrameBuffer()
+{
+    if (u_frameBufferOwner)
+    {
+#if defined(BOARD_HAS_PSRAM) // ESP32 PSRAM specific case
+
+        free(u_newFrameBuffer);
+
+#else // default case
+
+        delete[] (uint32_t *) u_newFrameBuffer;
+
+#endif // ESP32 BOARD_HAS_PSRAM
+    }
+
+    u_newFrameBuffer = 0; // nullptr
+    u_frameBufferSize = 0;
+    u_frameBufferOwner = false;
+}
+
 void Screen_EPD::clear(uint16_t colour)
 {
+    if (v_listRecord)
+    {
+        s_listRecord(LIST_CLEAR, 0, 0, screenSizeX() - 1, screenSizeY() - 1, &colour, 1);
+        return;
+    }
+
     uint8_t pattern;
 
-    switch (u_codeFilm)
+    // Next frame-buffer fully written, no copy from previous required
+    u_staleCount = 0;
+
+    switch (u_layout)
     {
-        case FILM_Q: // BWRY, "Spectra 4"
+        case LAYOUT_BWRY: // BWRY, "Spectra 4"
 
             if (colour == myColours.grey)
             {
@@ -405,8 +648,7 @@ void Screen_EPD::clear(uint16_t colour)
             }
             break;
 
-        case FILM_K: // Wide temperature and embedded fast update
-        case FILM_P: // Embedded fast update
+        case LAYOUT_BW: // Embedded fast update, monochrome
 
             if (colour == myColours.grey)
             {
@@ -432,7 +674,7 @@ void Screen_EPD::clear(uint16_t colour)
             }
             break;
 
-        default: // Normal update and deprecated
+        default: // LAYOUT_BWR, normal update and deprecated
 
             if (colour == myColours.red)
             {
@@ -498,6 +740,59 @@ void Screen_EPD::clear(uint16_t colour)
 
 void Screen_EPD::flush()
 {
+    if (u_memory != 0)
+    {
+        s_flushMemory();
+        return;
+    }
+
+    if (u_bandLines > 0)
+    {
+        s_flushBands();
+        return;
+    }
+
+    s_flush();
+}
+
+uint32_t Screen_EPD::flushFast()
+{
+    if (u_memory != 0)
+    {
+        return s_flushMemory();
+    }
+
+    if (u_bandLines > 0)
+    {
+        return s_flushBands();
+    }
+
+    return s_flush();
+}
+
+uint32_t Screen_EPD::s_flush(bool flagForce)
+{
+    uint32_t result = u_pageColourSize; // bytes sent
+
+    // Skip identical frames, embedded fast update only
+    if ((u_layout == LAYOUT_BW) and (u_flagPrevious == true) and (flagForce == false))
+    {
+        // Nothing drawn since previous update
+        if (u_staleCount == u_staleGroups)
+        {
+            return 0;
+        }
+
+        // Lines not drawn copied before comparison
+        s_syncLines(0, v_screenSizeV - 1);
+        result = s_countChanges(s_newImage, u_previousImage, u_pageColourSize);
+        if (result == 0)
+        {
+            return result;
+        }
+    }
+    s_syncLines(0, v_screenSizeV - 1);
+
     resume(); // GPIO
 
     if ((u_codeSize == SIZE_969) or (u_codeSize == SIZE_B98)) // Large
@@ -506,7 +801,7 @@ void Screen_EPD::flush()
         uint32_t u_subPageColourSize = (u_pageColourSize >> 1);
 
         FRAMEBUFFER_TYPE nextBuffer = s_newImage; // size = u_pageColourSize
-        FRAMEBUFFER_TYPE previousBuffer = s_newImage + u_pageColourSize; // size = u_pageColourSize
+        FRAMEBUFFER_TYPE previousBuffer = u_previousImage; // size = u_pageColourSize
 
         FRAMEBUFFER_TYPE frameM1 = nextBuffer; // size = u_pageColourSize
         FRAMEBUFFER_TYPE frameM2 = previousBuffer; // size = u_pageColourSize
@@ -524,11 +819,19 @@ void Screen_EPD::flush()
             case FILM_P: // Embedded fast update
 
                 s_driver->updateFast(frameM1, frameM2, frameS1, frameS2, u_subPageColourSize);
-                memcpy(previousBuffer, nextBuffer, u_pageColourSize); // Copy displayed next to previous
+                s_swapNext(); // Displayed next becomes previous
                 break;
 
             default:
 
+#if (ZERO_PAGE_SIZE > 0)
+                // Monochrome, both halves of the second page from the zero page
+                if (u_layout == LAYOUT_BW)
+                {
+                    frameM2 = (FRAMEBUFFER_TYPE)zeroPage;
+                    frameS2 = (FRAMEBUFFER_TYPE)zeroPage;
+                }
+#endif // ZERO_PAGE_SIZE
                 s_driver->updateNormal(frameM1, frameM2, frameS1, frameS2, u_subPageColourSize);
                 break;
         }
@@ -536,7 +839,7 @@ void Screen_EPD::flush()
     else // Small and medium
     {
         FRAMEBUFFER_TYPE nextBuffer = s_newImage; // size = u_pageColourSize
-        FRAMEBUFFER_TYPE previousBuffer = s_newImage + u_pageColourSize; // size = u_pageColourSize
+        FRAMEBUFFER_TYPE previousBuffer = u_previousImage; // size = u_pageColourSize
 
         switch (u_codeFilm)
         {
@@ -549,11 +852,18 @@ void Screen_EPD::flush()
             case FILM_P: // Embedded fast update
 
                 s_driver->updateFast(nextBuffer, previousBuffer, u_pageColourSize);
-                memcpy(previousBuffer, nextBuffer, u_pageColourSize); // Copy displayed next to previous
+                s_swapNext(); // Displayed next becomes previous
                 break;
 
             default:
 
+#if (ZERO_PAGE_SIZE > 0)
+                // Monochrome, second page from the zero page
+                if (u_layout == LAYOUT_BW)
+                {
+                    previousBuffer = (FRAMEBUFFER_TYPE)zeroPage;
+                }
+#endif // ZERO_PAGE_SIZE
                 s_driver->updateNormal(nextBuffer, previousBuffer, u_pageColourSize);
                 break;
         }
@@ -563,242 +873,1651 @@ void Screen_EPD::flush()
     {
         suspend(u_suspendScope); // GPIO
     }
+
+    return result;
+}
+
+uint32_t Screen_EPD::s_flushBands()
+{
+    if (((u_bandRender == 0) and (v_list == 0)) or (u_bandOutput == 0))
+    {
+        hV_HAL_log(LEVEL_ERROR, "Band functions not set");
+        return 0;
+    }
+
+    // State restored for each band
+    uint8_t oldOrientation = v_orientation;
+    bool oldPenSolid = v_penSolid;
+    bool oldFontSolid = f_fontSolid;
+    uint8_t oldFont = f_fontIndex;
+    uint8_t oldSpaceX = f_fontSpaceX;
+    uint8_t oldSpaceY = f_fontSpaceY;
+
+    uint32_t pageSize = (uint32_t)v_screenSizeV * u_bufferSizeH; // whole page
+    uint32_t result = 0;
+
+    // Panel not driven, output in charge of the transfer
+    for (uint16_t first = 0; first < v_screenSizeV; first += u_bandLines)
+    {
+        s_setBand(first, hV_HAL_min(u_bandLines, (uint16_t)(v_screenSizeV - first)));
+
+        selectFont(oldFont);
+        setFontSolid(oldFontSolid);
+        f_fontSpaceX = oldSpaceX;
+        f_fontSpaceY = oldSpaceY;
+        setPenSolid(oldPenSolid);
+        setOrientation(oldOrientation); // clip reset to the band
+
+        if (u_bandRender != 0)
+        {
+            u_bandRender(this);
+        }
+        else
+        {
+            replayList(); // commands outside the band skipped
+        }
+
+        for (uint8_t page = 0; page < u_bufferDepth; page++)
+        {
+            FRAMEBUFFER_TYPE band = s_newImage + page * u_pageColourSize;
+            if (u_layoutLarge)
+            {
+                // Two halves, each with lines of (u_bufferSizeH >> 1) bytes
+                uint32_t half = (u_pageColourSize >> 1);
+                u_bandOutput(page, (uint32_t)first * (u_bufferSizeH >> 1), band, half);
+                u_bandOutput(page, (pageSize >> 1) + (uint32_t)first * (u_bufferSizeH >> 1), band + half, half);
+            }
+            else
+            {
+                u_bandOutput(page, (uint32_t)first * u_bufferSizeH, band, u_pageColourSize);
+            }
+        }
+        result += u_pageColourSize;
+    }
+
+    // Back to the first band
+    s_setBand(0, u_bandLines);
+    setOrientation(oldOrientation);
+    return result;
 }
 
-void Screen_EPD::flushFast()
+void Screen_EPD::s_setBand(uint16_t first, uint16_t lines)
 {
-    flush();
+    u_bandFirst = first;
+    u_bufferSizeV = lines;
+    u_pageColourSize = (uint32_t)u_bufferSizeV * (uint32_t)u_bufferSizeH;
+    u_previousImage = s_newImage + u_pageColourSize;
+    u_staleCount = 0;
 }
 
-void Screen_EPD::regenerate(uint8_t mode)
+void Screen_EPD::s_resetClip()
 {
-    switch (u_codeFilm)
+    hV_Screen_Buffer::s_resetClip();
+
+    if ((u_bandLines > 0) and (u_memory == 0))
     {
-        case FILM_K: // Wide temperature and embedded fast update
-        case FILM_P: // Embedded fast update
+        s_clipBand();
+    }
+}
 
-            clear(myColours.black);
-            flushFast();
-            hV_HAL_delayMilliseconds(100);
+void Screen_EPD::s_clipBand()
+{
+    // Physical lines of the band along the logical axis of the orientation
+    uint16_t first = u_bandFirst;
+    uint16_t last = u_bandFirst + u_bufferSizeV - 1;
 
-            clear(myColours.white);
-            flushFast();
-            hV_HAL_delayMilliseconds(100);
+    switch (v_orientation)
+    {
+        case 3:
+
+            v_clipX1 = hV_HAL_max(v_clipX1, (uint16_t)(v_screenSizeV - 1 - last));
+            v_clipX2 = hV_HAL_min(v_clipX2, (uint16_t)(v_screenSizeV - 1 - first));
+            break;
+
+        case 2:
+
+            v_clipY1 = hV_HAL_max(v_clipY1, (uint16_t)(v_screenSizeV - 1 - last));
+            v_clipY2 = hV_HAL_min(v_clipY2, (uint16_t)(v_screenSizeV - 1 - first));
+            break;
+
+        case 1:
+
+            v_clipX1 = hV_HAL_max(v_clipX1, first);
+            v_clipX2 = hV_HAL_min(v_clipX2, last);
             break;
 
         default:
 
-            hV_HAL_delayMilliseconds(100);
-            clear();
-            flush();
+            v_clipY1 = hV_HAL_max(v_clipY1, first);
+            v_clipY2 = hV_HAL_min(v_clipY2, last);
             break;
     }
 }
 
-//
-// Protected section
-//
-void Screen_EPD::s_setPoint(uint16_t x1, uint16_t y1, uint16_t colour)
+uint32_t Screen_EPD::s_flushMemory()
 {
-    // Orient and check coordinates are within screen
-    if (s_orientCoordinates(x1, y1) == RESULT_ERROR)
+    if (u_bandOutput == 0)
+    {
+        hV_HAL_log(LEVEL_ERROR, "Output function not set");
+        return 0;
+    }
+
+    s_storeBand();
+    u_memoryLoaded = false; // cache used for the transfer
+
+    uint32_t pageSize = (uint32_t)v_screenSizeV * u_bufferSizeH; // whole page
+
+    // Panel not driven, output in charge of the transfer
+    // Chunks of the cache size, in the order of the page
+    for (uint8_t page = 0; page < u_bufferDepth; page++)
+    {
+        for (uint32_t offset = 0; offset < pageSize; offset += u_frameBufferSize)
+        {
+            uint32_t size = hV_HAL_min(u_frameBufferSize, pageSize - offset);
+            u_memory->read(page * pageSize + offset, u_newFrameBuffer, size);
+            u_bandOutput(page, offset, u_newFrameBuffer, size);
+        }
+    }
+
+    return pageSize;
+}
+
+void Screen_EPD::s_loadBand(uint16_t first)
+{
+    if (u_memoryLoaded and (first == u_bandFirst))
     {
         return;
     }
 
-    // Convert combined colours into basic colours
-    bool flagOdd = ((x1 + y1) % 2 == 0);
+    s_storeBand();
+    s_setBand(first, hV_HAL_min(u_bandLines, (uint16_t)(v_screenSizeV - first)));
+    s_transferBand(true);
+    u_memoryLoaded = true;
+}
 
-    // Coordinates
-    uint32_t z1 = s_getZ(x1, y1);
-    uint16_t b1 = s_getB(x1, y1);
+void Screen_EPD::s_storeBand()
+{
+    if (u_memoryLoaded and u_memoryDirty)
+    {
+        s_transferBand(false);
+    }
+    u_memoryDirty = false;
+}
 
-    switch (u_codeFilm)
+void Screen_EPD::s_transferBand(bool flagRead)
+{
+    uint32_t pageSize = (uint32_t)v_screenSizeV * u_bufferSizeH; // whole page
+
+    // Same positions as the output of banded rendering
+    for (uint8_t page = 0; page < u_bufferDepth; page++)
     {
-        case FILM_Q: // BWRY, "Spectra 4"
+        FRAMEBUFFER_TYPE band = s_newImage + page * u_pageColourSize;
+        uint32_t address = page * pageSize;
+        uint32_t addresses[2];
+        uint32_t size;
+        uint8_t parts;
 
-            // Combined colours
-            if (colour == myColours.grey)
-            {
-                if (flagOdd)
-                {
-                    colour = myColours.black; // black
-                }
-                else
-                {
-                    colour = myColours.white; // white
-                }
-            }
-            else if (colour == myColours.darkRed)
-            {
-                if (flagOdd)
-                {
-                    colour = myColours.red; // red
-                }
-                else
-                {
-                    colour = myColours.black; // white
-                }
-            }
-            else if (colour == myColours.lightRed)
-            {
-                if (flagOdd)
-                {
-                    colour = myColours.red; // red
-                }
-                else
-                {
-                    colour = myColours.white; // black
-                }
-            }
-            else if (colour == myColours.darkYellow)
-            {
-                if (flagOdd)
-                {
-                    colour = myColours.yellow; // yellow
-                }
-                else
-                {
-                    colour = myColours.black; // black
-                }
-            }
-            else if (colour == myColours.lightYellow)
-            {
-                if (flagOdd)
-                {
-                    colour = myColours.yellow; // yellow
-                }
-                else
-                {
-                    colour = myColours.white; // white
-                }
-            }
-            else if (colour == myColours.orange)
-            {
-                if (flagOdd)
-                {
-                    colour = myColours.yellow; // yellow
-                }
-                else
-                {
-                    colour = myColours.red; // red
-                }
-            }
+        if (u_layoutLarge)
+        {
+            // Two halves, each with lines of (u_bufferSizeH >> 1) bytes
+            size = (u_pageColourSize >> 1);
+            addresses[0] = address + (uint32_t)u_bandFirst * (u_bufferSizeH >> 1);
+            addresses[1] = address + (pageSize >> 1) + (uint32_t)u_bandFirst * (u_bufferSizeH >> 1);
+            parts = 2;
+        }
+        else
+        {
+            size = u_pageColourSize;
+            addresses[0] = address + (uint32_t)u_bandFirst * u_bufferSizeH;
+            parts = 1;
+        }
 
-            // Basic colours
-            if (colour == myColours.black)
+        for (uint8_t part = 0; part < parts; part++)
+        {
+            if (flagRead)
             {
-                // physical white = 0-0
-                bitClear(s_newImage[z1], b1 + 1); // MSB
-                bitClear(s_newImage[z1], b1);
+                u_memory->read(addresses[part], band + part * size, size);
             }
-            else if (colour == myColours.white)
+            else
             {
-                // physical black = 0-1
-                bitClear(s_newImage[z1], b1 + 1); // MSB
-                bitSet(s_newImage[z1], b1);
+                u_memory->write(addresses[part], band + part * size, size);
             }
-            else if (colour == myColours.yellow)
+        }
+    }
+}
+
+void Screen_EPD::s_listCommand(const uint16_t * item)
+{
+    if (u_memory == 0)
+    {
+        return;
+    }
+
+    // Bounding box within the clip rectangle, whole screen for clear()
+    bool flagClear = ((item[0] & 0xff) == LIST_CLEAR);
+    int32_t x1 = (flagClear) ? 0 : hV_HAL_max((int32_t)(int16_t)item[4], (int32_t)v_clipX1);
+    int32_t y1 = (flagClear) ? 0 : hV_HAL_max((int32_t)(int16_t)item[5], (int32_t)v_clipY1);
+    int32_t x2 = (flagClear) ? screenSizeX() - 1 : hV_HAL_min((int32_t)(int16_t)item[6], (int32_t)v_clipX2);
+    int32_t y2 = (flagClear) ? screenSizeY() - 1 : hV_HAL_min((int32_t)(int16_t)item[7], (int32_t)v_clipY2);
+    if ((x1 > x2) or (y1 > y2))
+    {
+        return;
+    }
+
+    // Bands of physical lines covered, band in cache first
+    uint16_t first = s_getLine(x1, y1);
+    uint16_t last = s_getLine(x2, y2);
+    if (first > last)
+    {
+        hV_HAL_swap(first, last);
+    }
+    uint16_t bandFirst = first / u_bandLines;
+    uint16_t number = last / u_bandLines - bandFirst + 1;
+    uint16_t bandCache = u_bandFirst / u_bandLines;
+    uint16_t start = (u_memoryLoaded and (bandCache >= bandFirst) and (bandCache < bandFirst + number)) ? bandCache - bandFirst : 0;
+
+    uint16_t oldClip[4] = { v_clipX1, v_clipY1, v_clipX2, v_clipY2 };
+    uint8_t oldClipDepth = v_clipDepth;
+    v_listRecord = false;
+
+    for (uint16_t i = 0; i < number; i++)
+    {
+        uint16_t band = bandFirst + (start + i) % number;
+        s_loadBand(band * u_bandLines);
+
+        s_clipBand();
+        if ((v_clipX1 <= v_clipX2) and (v_clipY1 <= v_clipY2))
+        {
+            s_listDraw(item);
+            u_memoryDirty = true;
+        }
+
+        v_clipX1 = oldClip[0];
+        v_clipY1 = oldClip[1];
+        v_clipX2 = oldClip[2];
+        v_clipY2 = oldClip[3];
+        v_clipDepth = oldClipDepth;
+    }
+
+    v_listRecord = true;
+}
+
+bool Screen_EPD::s_operateMemory(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2, uint8_t operation, uint16_t colour)
+{
+    bool result = true;
+
+    if (x1 > x2)
+    {
+        hV_HAL_swap(x1, x2);
+    }
+    if (y1 > y2)
+    {
+        hV_HAL_swap(y1, y2);
+    }
+    if ((x1 >= screenSizeX()) or (y1 >= screenSizeY()))
+    {
+        return result;
+    }
+    x2 = hV_HAL_min(x2, (uint16_t)(screenSizeX() - 1));
+    y2 = hV_HAL_min(y2, (uint16_t)(screenSizeY() - 1));
+
+    uint16_t first = s_getLine(x1, y1);
+    uint16_t last = s_getLine(x2, y2);
+    if (first > last)
+    {
+        hV_HAL_swap(first, last);
+    }
+
+    uint16_t oldClip[4] = { v_clipX1, v_clipY1, v_clipX2, v_clipY2 };
+    uint8_t oldClipDepth = v_clipDepth;
+    v_listRecord = false;
+
+    for (uint16_t band = first - (first % u_bandLines); band <= last; band += u_bandLines)
+    {
+        s_loadBand(band);
+
+        // Area limited to the band
+        s_resetClip();
+        s_clipBand();
+        uint16_t bx1 = hV_HAL_max(x1, v_clipX1);
+        uint16_t by1 = hV_HAL_max(y1, v_clipY1);
+        uint16_t bx2 = hV_HAL_min(x2, v_clipX2);
+        uint16_t by2 = hV_HAL_min(y2, v_clipY2);
+
+        v_clipX1 = oldClip[0];
+        v_clipY1 = oldClip[1];
+        v_clipX2 = oldClip[2];
+        v_clipY2 = oldClip[3];
+        v_clipDepth = oldClipDepth;
+
+        switch (operation)
+        {
+            case OPERATION_INVERT:
+
+                invert(bx1, by1, bx2, by2);
+                u_memoryDirty = true;
+                break;
+
+            case OPERATION_SWAP:
+
+                highlight(bx1, by1, bx2, by2, colour);
+                u_memoryDirty = true;
+                break;
+
+            default: // OPERATION_COMPARE
+
+                result &= isClear(bx1, by1, bx2, by2, colour);
+                break;
+        }
+    }
+
+    v_listRecord = true;
+    return result;
+}
+
+uint16_t Screen_EPD::s_getLine(uint16_t x1, uint16_t y1)
+{
+    switch (v_orientation)
+    {
+        case 3:
+
+            return v_screenSizeV - 1 - x1;
+
+        case 2:
+
+            return v_screenSizeV - 1 - y1;
+
+        case 1:
+
+            return x1;
+
+        default:
+
+            return y1;
+    }
+}
+
+void Screen_EPD::s_swapNext()
+{
+    hV_HAL_swap(s_newImage, u_previousImage);
+    u_flagPrevious = true;
+
+    // Copy deferred to first drawing on each group of lines
+    memset(u_staleMask, 0x00, sizeof(u_staleMask));
+    for (uint8_t group = 0; group < u_staleGroups; group += 1)
+    {
+        u_staleMask[group >> 3] |= (1 << (group & 0x07));
+    }
+    u_staleCount = u_staleGroups;
+}
+
+void Screen_EPD::s_syncLines(uint16_t first, uint16_t last, bool flagOverwrite)
+{
+    if (u_staleCount == 0)
+    {
+        return;
+    }
+
+    // Lines on both halves for large screens
+    uint32_t bytesH = (u_layoutLarge) ? (u_bufferSizeH >> 1) : u_bufferSizeH;
+    uint32_t half = (u_pageColourSize >> 1);
+
+    for (uint16_t group = first / u_staleLines; group <= last / u_staleLines; group += 1)
+    {
+        uint8_t bit = (1 << (group & 0x07));
+        if ((u_staleMask[group >> 3] & bit) == 0)
+        {
+            continue;
+        }
+
+        uint16_t line = group * u_staleLines;
+        uint16_t lines = hV_HAL_min(u_staleLines, (uint16_t)(v_screenSizeV - line));
+
+        // Group fully written, no copy required
+        if ((flagOverwrite == false) or (line < first) or (line + lines - 1 > last))
+        {
+            uint32_t z = line * bytesH;
+            memcpy(s_newImage + z, u_previousImage + z, lines * bytesH); // Copy displayed previous to next
+            if (u_layoutLarge)
             {
-                // physical yellow = 1-0
-                bitSet(s_newImage[z1], b1 + 1); // MSB
-                bitClear(s_newImage[z1], b1);
+                memcpy(s_newImage + half + z, u_previousImage + half + z, lines * bytesH);
             }
-            else if (colour == myColours.red)
+        }
+
+        u_staleMask[group >> 3] &= ~bit;
+        u_staleCount -= 1;
+    }
+}
+
+bool Screen_EPD::s_isStale(uint16_t line)
+{
+    if (u_staleCount == 0)
+    {
+        return false;
+    }
+
+    uint16_t group = line / u_staleLines;
+    return ((u_staleMask[group >> 3] & (1 << (group & 0x07))) != 0);
+}
+
+uint32_t Screen_EPD::s_countChanges(FRAMEBUFFER_TYPE next, FRAMEBUFFER_TYPE previous, uint32_t size)
+{
+    uint32_t result = 0;
+    uint32_t index = 0;
+    uint32_t word1, word2, delta;
+
+    // Word-wide, memcpy() for unaligned buffers
+    for (; index + 4 <= size; index += 4)
+    {
+        memcpy(&word1, next + index, 4);
+        memcpy(&word2, previous + index, 4);
+        delta = word1 ^ word2;
+
+        if (delta != 0)
+        {
+            result += ((delta & 0x000000ff) != 0) + ((delta & 0x0000ff00) != 0) + ((delta & 0x00ff0000) != 0) + ((delta & 0xff000000) != 0);
+        }
+    }
+
+    // Remaining bytes
+    for (; index < size; index += 1)
+    {
+        if (next[index] != previous[index])
+        {
+            result += 1;
+        }
+    }
+
+    return result;
+}
+
+void Screen_EPD::regenerate(uint8_t mode)
+{
+    switch (u_codeFilm)
+    {
+        case FILM_K: // Wide temperature and embedded fast update
+        case FILM_P: // Embedded fast update
+
+            // Whole frame-buffer required, see setBands() and setExternalMemory()
+            if (u_bandLines > 0)
+            {
+                hV_HAL_log(LEVEL_ERROR, "Regenerate not available with bands");
+                return;
+            }
+
+            clear(myColours.black);
+            s_flush(true);
+            hV_HAL_delayMilliseconds(100);
+
+            clear(myColours.white);
+            s_flush(true);
+            hV_HAL_delayMilliseconds(100);
+            break;
+
+        default:
+
+            hV_HAL_delayMilliseconds(100);
+            clear();
+            flush();
+            break;
+    }
+}
+
+//
+// Protected section
+//
+void Screen_EPD::s_setPoint(uint16_t x1, uint16_t y1, uint16_t colour)
+{
+    // Check coordinates are within clip rectangle, hence within screen
+    if ((x1 < v_clipX1) or (x1 > v_clipX2) or (y1 < v_clipY1) or (y1 > v_clipY2))
+    {
+        return;
+    }
+
+    s_setPointInside(x1, y1, colour);
+}
+
+void Screen_EPD::s_setPointInside(uint16_t x1, uint16_t y1, uint16_t colour)
+{
+    // Coordinates already clipped, orientation only
+    switch (v_orientation)
+    {
+        case 3:
+
+            x1 = v_screenSizeV - 1 - x1;
+            break;
+
+        case 2:
+
+            x1 = v_screenSizeH - 1 - x1;
+            y1 = v_screenSizeV - 1 - y1;
+            hV_HAL_swap(x1, y1);
+            break;
+
+        case 1:
+
+            y1 = v_screenSizeH - 1 - y1;
+            break;
+
+        default:
+
+            hV_HAL_swap(x1, y1);
+            break;
+    }
+    x1 -= u_bandFirst;
+
+    uint8_t code = s_getCode(colour, x1, y1);
+    if (code == PEN_NONE)
+    {
+        return;
+    }
+
+    s_syncLines(x1, x1);
+    (this->*u_kernel)(x1, y1, code);
+}
+
+uint8_t Screen_EPD::s_getCode(uint16_t colour, uint16_t x1, uint16_t y1)
+{
+    // Convert colour only when changed
+    if (colour != u_penColour)
+    {
+        s_setPen(colour);
+    }
+
+    // Combined colours alternate on even and odd pixels, other colours dithered
+    return (u_penEntry == 0) ? u_penCode[(x1 + y1) & 0x01] : s_getDitherCode(u_penEntry, x1, y1);
+}
+
+void Screen_EPD::s_setBitmap(uint16_t x0, uint16_t y0, const uint8_t * bitmap, uint16_t width, uint16_t height,
+                             uint8_t format, const uint16_t * palette, bool flagTransparent, uint16_t transparent)
+{
+    // Rows of the bitmap along the bytes of the frame-buffer only with default orientation
+    uint8_t pixelsPerByte = (u_layout == LAYOUT_BWRY) ? 4 : 8;
+    if ((v_orientation != 0) or (x0 % pixelsPerByte != 0)
+            or (x0 < v_clipX1) or (y0 < v_clipY1) or (x0 + width > v_clipX2 + 1) or (y0 + height > v_clipY2 + 1)
+            or (u_layoutLarge and ((v_screenSizeH >> 1) % pixelsPerByte != 0)))
+    {
+        hV_Screen_Buffer::s_setBitmap(x0, y0, bitmap, width, height, format, palette, flagTransparent, transparent);
+        return;
+    }
+
+    // Physical lines y0 to y0 + height - 1, default orientation
+    s_syncLines(y0, y0 + height - 1);
+
+    uint8_t pages = (u_layout == LAYOUT_BWR) ? 2 : 1;
+    uint32_t bytesRow = ((uint32_t)width * format + 7) >> 3;
+
+    // Solid colours for 1-bit bitmap, whole bytes copied
+    // x1 = y0 and y1 = x0 physical, default orientation
+    uint8_t codes[2] = { PEN_NONE, PEN_NONE };
+    bool flagBytes = ((format == BITMAP_1BPP) and (u_layout != LAYOUT_BWRY));
+    if (flagBytes)
+    {
+        for (uint8_t k = 0; k < 2; k++)
+        {
+            if (flagTransparent and (transparent == k))
+            {
+                continue;
+            }
+            s_setPen(palette[k]);
+            if ((u_penEntry == 0) and (u_penCode[0] == u_penCode[1]) and (u_penCode[0] != PEN_NONE))
+            {
+                codes[k] = u_penCode[0];
+            }
+            else
+            {
+                flagBytes = false; // combined or dithered colour
+            }
+        }
+    }
+
+    if (flagBytes)
+    {
+        for (uint16_t j = 0; j < height; j++)
+        {
+            const uint8_t * row = bitmap + j * bytesRow;
+            for (uint16_t i = 0; i < width; i += 8)
+            {
+                uint32_t z1 = s_getZ(y0 + j - u_bandFirst, x0 + i);
+                uint8_t mask = (width - i < 8) ? (0xff << (8 - (width - i))) : 0xff;
+                uint8_t source = row[i >> 3];
+
+                for (uint8_t page = 0; page < pages; page++)
+                {
+                    uint8_t * target = s_newImage + z1 + page * u_pageColourSize;
+                    uint8_t value = 0x00;
+                    uint8_t maskPage = mask;
+
+                    if (codes[1] != PEN_NONE)
+                    {
+                        value |= (((codes[1] >> page) & 0x01) ? 0xff : 0x00) & source;
+                    }
+                    else
+                    {
+                        maskPage &= ~source;
+                    }
+
+                    if (codes[0] != PEN_NONE)
+                    {
+                        value |= (((codes[0] >> page) & 0x01) ? 0xff : 0x00) & ~source;
+                    }
+                    else
+                    {
+                        maskPage &= source;
+                    }
+
+                    *target = (*target & ~maskPage) | (value & maskPage);
+                }
+            }
+        }
+        return;
+    }
+
+    // Pixels packed into bytes, then bytes written
+    uint16_t colour;
+    for (uint16_t j = 0; j < height; j++)
+    {
+        const uint8_t * row = bitmap + j * bytesRow;
+        uint16_t x1 = y0 + j - u_bandFirst;
+
+        for (uint16_t i = 0; i < width; i += pixelsPerByte)
+        {
+            uint32_t z1 = s_getZ(x1, x0 + i);
+            uint8_t value[2] = { 0x00, 0x00 };
+            uint8_t mask = 0x00;
+
+            for (uint8_t k = 0; (k < pixelsPerByte) and (i + k < width); k++)
+            {
+                if (s_getBitmapColour(row, i + k, format, palette, flagTransparent, transparent, colour) == false)
+                {
+                    continue;
+                }
+
+                uint8_t code = s_getCode(colour, x1, x0 + i + k);
+                if (code == PEN_NONE)
+                {
+                    continue;
+                }
+
+                if (u_layout == LAYOUT_BWRY)
+                {
+                    uint8_t b1 = 6 - 2 * k;
+                    mask |= 0b11 << b1;
+                    value[0] |= code << b1;
+                }
+                else
+                {
+                    uint8_t b1 = 7 - k;
+                    mask |= 1 << b1;
+                    value[0] |= (code & 0b01) << b1;
+                    value[1] |= ((code >> 1) & 0b01) << b1;
+                }
+            }
+
+            for (uint8_t page = 0; page < pages; page++)
+            {
+                uint8_t * target = s_newImage + z1 + page * u_pageColourSize;
+                *target = (*target & ~mask) | (value[page] & mask);
+            }
+        }
+    }
+}
+
+void Screen_EPD::s_setCharacter(uint16_t x0, uint16_t y0, uint16_t glyph, uint16_t textColour, uint16_t backColour)
+{
+    uint16_t x1 = x0;
+    uint16_t y1 = y0;
+    uint16_t x2 = x0 + f_getWidth(glyph) - 1;
+    uint16_t y2 = y0 + f_font.height - 1;
+
+    // Glyph fully within clip rectangle
+    bool flagFast = (x1 >= v_clipX1) and (y1 >= v_clipY1) and (x2 <= v_clipX2) and (y2 <= v_clipY2);
+
+    // Codes converted only when colours change
+    if ((u_glyphPen == false) or (backColour != u_glyphColours[0]) or (textColour != u_glyphColours[1]))
+    {
+        u_glyphColours[0] = backColour;
+        u_glyphColours[1] = textColour;
+        for (uint8_t k = 0; k < 2; k++)
+        {
+            s_setPen(u_glyphColours[k]);
+
+            // Solid colours only, combined, dithered or unsupported colours excluded
+            bool flagSolid = (u_penEntry == 0) and (u_penCode[0] == u_penCode[1]);
+            u_glyphCodes[k] = (flagSolid) ? u_penCode[0] : PEN_NONE;
+        }
+        u_glyphPen = true;
+    }
+
+    // Background only for solid font
+    uint8_t codes[2] = { PEN_NONE, u_glyphCodes[1] }; // background, text
+    if (f_fontSolid)
+    {
+        codes[0] = u_glyphCodes[0];
+        flagFast &= (codes[0] != PEN_NONE);
+    }
+    flagFast &= (codes[1] != PEN_NONE);
+
+    // Physical box of the glyph, on one half for large screens
+    if (flagFast)
+    {
+        s_orientArea(x1, y1, x2, y2);
+        if (u_layoutLarge and (y1 < (v_screenSizeH >> 1)) and (y2 >= (v_screenSizeH >> 1)))
+        {
+            flagFast = false;
+        }
+    }
+
+    uint32_t * rows = (flagFast) ? s_getGlyph(glyph) : 0;
+    if (rows == 0)
+    {
+        hV_Screen_Buffer::s_setCharacter(x0, y0, glyph, textColour, backColour);
+        return;
+    }
+
+    s_syncLines(x1, x2);
+
+    uint32_t z0 = 0;
+    uint16_t bytesH = u_bufferSizeH;
+    if (u_layoutLarge)
+    {
+        if (y1 >= (v_screenSizeH >> 1))
+        {
+            y1 -= (v_screenSizeH >> 1); // rebase y1 and y2
+            y2 -= (v_screenSizeH >> 1);
+            z0 = (u_pageColourSize >> 1); // buffer second half
+        }
+        bytesH = (u_bufferSizeH >> 1);
+    }
+
+    uint8_t shift = (u_layout == LAYOUT_BWRY) ? 2 : 3; // 4 or 8 pixels per byte
+    uint8_t bits = (u_layout == LAYOUT_BWRY) ? 2 : 1; // 2 or 1 bit per pixel
+    uint8_t offset = bits * (y1 & ((1 << shift) - 1)); // first bit in first byte
+    uint8_t length = bits * (y2 - y1 + 1); // bits per row
+    uint8_t count = (offset + length + 7) >> 3; // bytes per row
+    uint8_t pages = (u_layout == LAYOUT_BWR) ? 2 : 1;
+    z0 += (uint32_t)x1 * bytesH + (y1 >> shift);
+
+    // Rows wider than the 64-bit mask, pixel by pixel
+    if (offset + length > 64)
+    {
+        hV_Screen_Buffer::s_setCharacter(x0, y0, glyph, textColour, backColour);
+        return;
+    }
+
+    // Whole bytes of background and text per page
+    uint8_t fills[2][2] = { { 0x00, 0x00 }, { 0x00, 0x00 } };
+    for (uint8_t k = 0; k < 2; k++)
+    {
+        if (codes[k] == PEN_NONE)
+        {
+            continue;
+        }
+        for (uint8_t page = 0; page < pages; page++)
+        {
+            if (u_layout == LAYOUT_BWRY)
+            {
+                fills[k][page] = codes[k] * 0x55; // 4 pixels per byte
+            }
+            else
+            {
+                fills[k][page] = ((codes[k] >> page) & 0x01) ? 0xff : 0x00;
+            }
+        }
+    }
+
+    // Rows of the glyph box, first pixel on bit 63
+    uint64_t box = (~(uint64_t)0 << (64 - length)) >> offset;
+
+    for (uint16_t x = 0; x <= x2 - x1; x++)
+    {
+        uint64_t fore = (uint64_t)rows[x] << 32;
+        if (bits == 2)
+        {
+            // 1 bit into 2 bits per pixel
+            fore = (fore | (fore >> 16)) & 0xffff0000ffff0000;
+            fore = (fore | (fore >> 8)) & 0xff00ff00ff00ff00;
+            fore = (fore | (fore >> 4)) & 0xf0f0f0f0f0f0f0f0;
+            fore = (fore | (fore >> 2)) & 0xcccccccccccccccc;
+            fore = (fore | (fore >> 1)) & 0xaaaaaaaaaaaaaaaa;
+            fore |= (fore >> 1);
+        }
+        fore >>= offset;
+        uint64_t mask = (f_fontSolid) ? box : fore;
+
+        for (uint8_t page = 0; page < pages; page++)
+        {
+            FRAMEBUFFER_TYPE item = s_newImage + page * u_pageColourSize + z0 + (uint32_t)x * bytesH;
+
+            for (uint8_t k = 0; k < count; k++)
+            {
+                uint8_t maskByte = mask >> (56 - 8 * k);
+                if (maskByte == 0x00)
+                {
+                    continue;
+                }
+                uint8_t foreByte = fore >> (56 - 8 * k);
+                uint8_t value = (fills[1][page] & foreByte) | (fills[0][page] & ~foreByte);
+                item[k] = (item[k] & ~maskByte) | (value & maskByte);
+            }
+        }
+    }
+}
+
+uint32_t * Screen_EPD::s_getGlyph(uint16_t glyph)
+{
+#if (GLYPH_CACHE_SLOTS > 0)
+
+    uint8_t width = f_getWidth(glyph);
+    uint8_t height = f_font.height;
+    uint8_t rows = hV_HAL_max(f_font.maxWidth, height);
+
+    // Rows of 32 pixels at most
+    if (rows > 32)
+    {
+        return 0; // nullptr
+    }
+
+    // Cache emptied when font or orientation changes
+    if ((u_glyphFont != f_fontIndex) or (u_glyphOrientation != v_orientation))
+    {
+        if (rows != u_glyphRows)
+        {
+            delete[] u_glyphCache;
+            u_glyphCache = new (std::nothrow) uint32_t[GLYPH_CACHE_SLOTS * rows];
+            u_glyphRows = (u_glyphCache == 0) ? 0 : rows;
+            if (u_glyphCache == 0)
+            {
+                hV_HAL_log(LEVEL_ERROR, "Glyph cache not created");
+            }
+        }
+        for (uint16_t slot = 0; slot < GLYPH_CACHE_SLOTS; slot++)
+        {
+            u_glyphKey[slot] = 0xffff;
+        }
+        u_glyphFont = f_fontIndex;
+        u_glyphOrientation = v_orientation;
+    }
+
+    if (u_glyphCache == 0)
+    {
+        return 0; // nullptr
+    }
+
+    uint16_t slot = glyph % GLYPH_CACHE_SLOTS;
+    uint32_t * cached = u_glyphCache + slot * u_glyphRows;
+
+    if (u_glyphKey[slot] != glyph)
+    {
+        // Columns transposed into physical rows
+        memset(cached, 0x00, u_glyphRows * sizeof(uint32_t));
+
+        for (uint8_t i = 0; i < width; i++)
+        {
+            uint32_t column = s_getColumn(glyph, i);
+
+            for (uint8_t row = 0; row < height; row++)
             {
-                // physical red = 1-1
-                bitSet(s_newImage[z1], b1 + 1); // MSB
-                bitSet(s_newImage[z1], b1);
+                if (bitRead(column, row) == 0)
+                {
+                    continue;
+                }
+
+                // Physical coordinates relative to the glyph box
+                uint8_t x, y;
+                switch (v_orientation)
+                {
+                    case 3:
+
+                        x = width - 1 - i;
+                        y = row;
+                        break;
+
+                    case 2:
+
+                        x = height - 1 - row;
+                        y = width - 1 - i;
+                        break;
+
+                    case 1:
+
+                        x = i;
+                        y = height - 1 - row;
+                        break;
+
+                    default:
+
+                        x = row;
+                        y = i;
+                        break;
+                }
+                cached[x] |= (uint32_t)0x80000000 >> y;
             }
+        }
+        u_glyphKey[slot] = glyph;
+    }
+
+    return cached;
+
+#else
+
+    return 0; // nullptr, no cache
+
+#endif // GLYPH_CACHE_SLOTS
+}
+
+void Screen_EPD::s_selectKernel()
+{
+    switch (s_driver->d_COG)
+    {
+        case COG_BWRY_LARGE:
+        case COG_FAST_LARGE:
+        case COG_WIDE_LARGE:
+        case COG_NORMAL_LARGE:
+
+            u_layoutLarge = true;
+            break;
+
+        default:
+
+            u_layoutLarge = false;
+            break;
+    }
+
+    switch (u_codeFilm)
+    {
+        case FILM_Q: // BWRY, "Spectra 4"
+
+            u_layout = LAYOUT_BWRY;
             break;
 
         case FILM_K: // Wide temperature and embedded fast update
         case FILM_P: // Embedded fast update
 
-            // Combined colours
-            if (colour == myColours.grey)
+            u_layout = LAYOUT_BW;
+            break;
+
+        default: // Normal update and deprecated
+
+            u_layout = LAYOUT_BWR;
+
+            // Monochrome, single page, second page sent from the zero page
+            if (u_monochrome)
             {
-                if (flagOdd)
+#if (ZERO_PAGE_SIZE > 0)
+                uint32_t zeroSize = (u_layoutLarge) ? (u_pageColourSize >> 1) : u_pageColourSize;
+                if (zeroSize <= ZERO_PAGE_SIZE)
                 {
-                    colour = myColours.black; // black
+                    u_layout = LAYOUT_BW;
+                    u_bufferDepth = 1;
                 }
                 else
                 {
-                    colour = myColours.white; // white
+                    hV_HAL_log(LEVEL_ERROR, "Zero page too small [%i]", zeroSize);
                 }
+#else
+                hV_HAL_log(LEVEL_INFO, "Monochrome mode disabled at build time, see ZERO_PAGE_SIZE");
+#endif // ZERO_PAGE_SIZE
+            }
+            break;
+    }
+
+    switch (u_layout)
+    {
+        case LAYOUT_BWRY:
+
+            u_kernel = (u_layoutLarge) ? &Screen_EPD::s_kernelLargeBWRY : &Screen_EPD::s_kernelBWRY;
+            break;
+
+        case LAYOUT_BW:
+
+            u_kernel = (u_layoutLarge) ? &Screen_EPD::s_kernelLargeBW : &Screen_EPD::s_kernelBW;
+            break;
+
+        default:
+
+            u_kernel = (u_layoutLarge) ? &Screen_EPD::s_kernelLargeBWR : &Screen_EPD::s_kernelBWR;
+            break;
+    }
+
+    if (u_ditherSize != DITHER_NONE)
+    {
+        s_setDitherTable();
+    }
+    s_setPen(myColours.black);
+}
+
+void Screen_EPD::s_setPen(uint16_t colour)
+{
+    // Combined colours into basic colours, even and odd pixels
+    uint16_t colours[2] = { colour, colour };
+
+    switch (u_layout)
+    {
+        case LAYOUT_BWRY:
+
+            if (colour == myColours.grey)
+            {
+                colours[0] = myColours.black;
+                colours[1] = myColours.white;
+            }
+            else if (colour == myColours.darkRed)
+            {
+                colours[0] = myColours.red;
+                colours[1] = myColours.black;
+            }
+            else if (colour == myColours.lightRed)
+            {
+                colours[0] = myColours.red;
+                colours[1] = myColours.white;
             }
+            else if (colour == myColours.darkYellow)
+            {
+                colours[0] = myColours.yellow;
+                colours[1] = myColours.black;
+            }
+            else if (colour == myColours.lightYellow)
+            {
+                colours[0] = myColours.yellow;
+                colours[1] = myColours.white;
+            }
+            else if (colour == myColours.orange)
+            {
+                colours[0] = myColours.yellow;
+                colours[1] = myColours.red;
+            }
+            break;
 
-            // Basic colours
-            if (colour == myColours.white)
+        case LAYOUT_BW:
+
+            if (colour == myColours.grey)
             {
-                // physical black 0-0
-                bitClear(s_newImage[z1], b1);
+                colours[0] = myColours.black;
+                colours[1] = myColours.white;
             }
-            else if (colour == myColours.black)
+            break;
+
+        default:
+
+            if (colour == myColours.darkRed)
             {
-                // physical white 1-0
-                bitSet(s_newImage[z1], b1);
+                colours[0] = myColours.red;
+                colours[1] = myColours.black;
+            }
+            else if (colour == myColours.lightRed)
+            {
+                colours[0] = myColours.red;
+                colours[1] = myColours.white;
+            }
+            else if (colour == myColours.grey)
+            {
+                colours[0] = myColours.black;
+                colours[1] = myColours.white;
+            }
+            break;
+    }
+
+    // Basic colours into physical codes
+    for (uint8_t i = 0; i < 2; i += 1)
+    {
+        uint8_t code = PEN_NONE;
+
+        switch (u_layout)
+        {
+            case LAYOUT_BWRY:
+
+                if (colours[i] == myColours.black)
+                {
+                    code = 0b00; // physical white = 0-0
+                }
+                else if (colours[i] == myColours.white)
+                {
+                    code = 0b01; // physical black = 0-1
+                }
+                else if (colours[i] == myColours.yellow)
+                {
+                    code = 0b10; // physical yellow = 1-0
+                }
+                else if (colours[i] == myColours.red)
+                {
+                    code = 0b11; // physical red = 1-1
+                }
+                break;
+
+            case LAYOUT_BW:
+
+                if (colours[i] == myColours.white)
+                {
+                    code = 0b0; // physical black 0-0
+                }
+                else if (colours[i] == myColours.black)
+                {
+                    code = 0b1; // physical white 1-0
+                }
+                break;
+
+            default:
+
+                // bit 0 = first page, bit 1 = second page
+                if (colours[i] == myColours.red)
+                {
+                    code = 0b10; // physical red 0-1
+                }
+                else if (colours[i] == myColours.white)
+                {
+                    code = 0b00; // physical black 0-0
+                }
+                else if (colours[i] == myColours.black)
+                {
+                    code = 0b01; // physical white 1-0
+                }
+                break;
+        }
+
+        u_penCode[i] = code;
+    }
+
+    // Other colours, dithered
+    u_penEntry = 0;
+    if ((u_penCode[0] == PEN_NONE) and (u_ditherSize != DITHER_NONE))
+    {
+        uint8_t entry = s_getDitherEntry(colour);
+
+        if ((u_ditherSize == DITHER_NEAREST) or ((entry & 0x0f) == 0))
+        {
+            u_penCode[0] = ((entry & 0x0f) < 8) ? (entry >> 6) : ((entry >> 4) & 0x03);
+            u_penCode[1] = u_penCode[0];
+        }
+        else
+        {
+            u_penCode[0] = entry >> 6;
+            u_penCode[1] = (entry >> 4) & 0x03;
+            u_penEntry = entry;
+        }
+    }
+
+    // Byte patterns, for first pixel even or odd
+    for (uint8_t page = 0; page < 2; page += 1)
+    {
+        for (uint8_t parity = 0; parity < 2; parity += 1)
+        {
+            uint8_t pattern = 0;
+
+            if (u_penCode[0] != PEN_NONE)
+            {
+                if (u_layout == LAYOUT_BWRY)
+                {
+                    for (uint8_t j = 0; j < 4; j += 1)
+                    {
+                        pattern |= u_penCode[(parity + j) & 0x01] << (6 - 2 * j); // 4 pixels per byte
+                    }
+                }
+                else
+                {
+                    for (uint8_t j = 0; j < 8; j += 1)
+                    {
+                        pattern |= ((u_penCode[(parity + j) & 0x01] >> page) & 0x01) << (7 - j); // 8 pixels per byte
+                    }
+                }
             }
+
+            u_penPattern[page][parity] = pattern;
+        }
+    }
+
+    u_penColour = colour;
+}
+
+void Screen_EPD::s_setSpanX(uint16_t x1, uint16_t x2, uint16_t y1, uint16_t colour)
+{
+    if (x1 > x2)
+    {
+        hV_HAL_swap(x1, x2);
+    }
+    if ((y1 < v_clipY1) or (y1 > v_clipY2))
+    {
+        return;
+    }
+    x1 = hV_HAL_max(x1, v_clipX1);
+    x2 = hV_HAL_min(x2, v_clipX2);
+    if (x1 > x2)
+    {
+        return;
+    }
+
+    s_setSpan(x1, y1, x2, y1, colour);
+}
+
+void Screen_EPD::s_setSpanY(uint16_t x1, uint16_t y1, uint16_t y2, uint16_t colour)
+{
+    if (y1 > y2)
+    {
+        hV_HAL_swap(y1, y2);
+    }
+    if ((x1 < v_clipX1) or (x1 > v_clipX2))
+    {
+        return;
+    }
+    y1 = hV_HAL_max(y1, v_clipY1);
+    y2 = hV_HAL_min(y2, v_clipY2);
+    if (y1 > y2)
+    {
+        return;
+    }
+
+    s_setSpan(x1, y1, x1, y2, colour);
+}
+
+void Screen_EPD::s_setSpan(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2, uint16_t colour)
+{
+    // Both ends within screen, physical coordinates
+    s_orientCoordinates(x1, y1);
+    s_orientCoordinates(x2, y2);
+
+    if (colour != u_penColour)
+    {
+        s_setPen(colour);
+    }
+    if (u_penCode[0] == PEN_NONE)
+    {
+        return;
+    }
+
+    s_syncLines(hV_HAL_min(x1, x2), hV_HAL_max(x1, x2));
+    if (u_penEntry != 0) // Dithered
+    {
+        s_setBlockDither(hV_HAL_min(x1, x2), hV_HAL_max(x1, x2), hV_HAL_min(y1, y2), hV_HAL_max(y1, y2));
+    }
+    else if (x1 == x2) // Along the bytes
+    {
+        if (y1 > y2)
+        {
+            hV_HAL_swap(y1, y2);
+        }
+        s_setBlock(x1, x1, y1, y2);
+    }
+    else // Across the bytes
+    {
+        if (x1 > x2)
+        {
+            hV_HAL_swap(x1, x2);
+        }
+        s_setRunStrided(x1, x2, y1);
+    }
+}
+
+void Screen_EPD::s_setRectangle(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2, uint16_t colour)
+{
+    if (s_clipArea(x1, y1, x2, y2) == RESULT_ERROR)
+    {
+        return;
+    }
+
+    if (colour != u_penColour)
+    {
+        s_setPen(colour);
+    }
+    if (u_penCode[0] == PEN_NONE)
+    {
+        return;
+    }
+
+    // Opposite corners, physical coordinates
+    s_orientCoordinates(x1, y1);
+    s_orientCoordinates(x2, y2);
+
+    if (x1 > x2)
+    {
+        hV_HAL_swap(x1, x2);
+    }
+    if (y1 > y2)
+    {
+        hV_HAL_swap(y1, y2);
+    }
+
+    // Whole lines, no copy from previous required
+    s_syncLines(x1, x2, (y1 == 0) and (y2 == v_screenSizeH - 1));
+
+    if (u_penEntry != 0) // Dithered
+    {
+        s_setBlockDither(x1, x2, y1, y2);
+    }
+    else
+    {
+        s_setBlock(x1, x2, y1, y2);
+    }
+}
+
+void Screen_EPD::s_setBlockDither(uint16_t x1, uint16_t x2, uint16_t y1, uint16_t y2)
+{
+    for (uint16_t x = x1; x <= x2; x += 1)
+    {
+        for (uint16_t y = y1; y <= y2; y += 1)
+        {
+            (this->*u_kernel)(x, y, s_getDitherCode(u_penEntry, x, y));
+        }
+    }
+}
+
+void Screen_EPD::s_setDitherTable()
+{
+    const uint8_t (* palette)[4];
+    uint8_t number;
+
+    switch (u_layout)
+    {
+        case LAYOUT_BWRY:
+
+            palette = paletteBWRY;
+            number = 4;
+            break;
+
+        case LAYOUT_BW:
+
+            palette = paletteBW;
+            number = 2;
+            break;
+
+        default:
+
+            palette = paletteBWR;
+            number = 3;
             break;
+    }
 
-        default:
+    // Weights for red, green, blue
+    const int32_t weightR = 3;
+    const int32_t weightG = 6;
+    const int32_t weightB = 1;
 
-            // Combined colours
-            if (colour == myColours.darkRed)
-            {
-                if (flagOdd)
-                {
-                    colour = myColours.red; // red
-                }
-                else
-                {
-                    colour = myColours.black; // white
-                }
-            }
-            else if (colour == myColours.lightRed)
+    for (uint16_t index = 0; index < 256; index += 1)
+    {
+        // RGB 3-3-2 to 8-8-8
+        int32_t r = ((index >> 5) & 0x07) * 255 / 7;
+        int32_t g = ((index >> 2) & 0x07) * 255 / 7;
+        int32_t b = (index & 0x03) * 255 / 3;
+
+        int32_t errorMin = INT32_MAX;
+        uint8_t entry = 0;
+
+        // Mix of two colours of the palette, with level in 1/16
+        for (uint8_t i = 0; i < number; i += 1)
+        {
+            for (uint8_t j = i; j < number; j += 1)
             {
-                if (flagOdd)
+                int32_t dr = palette[j][1] - palette[i][1];
+                int32_t dg = palette[j][2] - palette[i][2];
+                int32_t db = palette[j][3] - palette[i][3];
+                int32_t norm = weightR * dr * dr + weightG * dg * dg + weightB * db * db;
+                int32_t level = 0;
+
+                if (norm > 0)
                 {
-                    colour = myColours.red; // red
+                    int32_t dot = weightR * (r - palette[i][1]) * dr + weightG * (g - palette[i][2]) * dg + weightB * (b - palette[i][3]) * db;
+                    level = (dot * 16 + norm / 2) / norm;
+                    level = hV_HAL_max(hV_HAL_min(level, (int32_t)16), (int32_t)0);
                 }
-                else
+
+                int32_t er = r - palette[i][1] - dr * level / 16;
+                int32_t eg = g - palette[i][2] - dg * level / 16;
+                int32_t eb = b - palette[i][3] - db * level / 16;
+                int32_t error = weightR * er * er + weightG * eg * eg + weightB * eb * eb;
+
+                if (error < errorMin)
                 {
-                    colour = myColours.white; // black
+                    errorMin = error;
+                    if (level == 16)
+                    {
+                        entry = (palette[j][0] << 6) | (palette[j][0] << 4);
+                    }
+                    else
+                    {
+                        entry = (palette[i][0] << 6) | (palette[j][0] << 4) | level;
+                    }
                 }
             }
-            else if (colour == myColours.grey)
+        }
+
+        u_ditherTable[index] = entry;
+    }
+}
+
+uint8_t Screen_EPD::s_getDitherEntry(uint16_t colour)
+{
+    // RGB 5-6-5 to RGB 3-3-2
+    return u_ditherTable[((colour >> 8) & 0xe0) | ((colour >> 6) & 0x1c) | ((colour >> 3) & 0x03)];
+}
+
+uint8_t Screen_EPD::s_getDitherCode(uint8_t entry, uint16_t x1, uint16_t y1)
+{
+    uint8_t level = entry & 0x0f;
+    uint8_t mask = u_ditherSize - 1;
+    uint8_t shift = (u_ditherSize == DITHER_8X8) ? 0 : ((u_ditherSize == DITHER_4X4) ? 2 : 4);
+    uint8_t threshold = bayer8x8[y1 & mask][x1 & mask] >> shift;
+    uint16_t area = u_ditherSize * u_ditherSize;
+
+    // Second code when level / 16 > (threshold + 1/2) / area
+    return ((uint16_t)(2 * level * area) > (uint16_t)((2 * threshold + 1) * 16)) ? ((entry >> 4) & 0x03) : (entry >> 6);
+}
+
+void Screen_EPD::s_setBlock(uint16_t x1, uint16_t x2, uint16_t y1, uint16_t y2)
+{
+    uint32_t z0 = 0;
+    uint16_t bytesH = u_bufferSizeH;
+    uint16_t y0 = 0; // rebase
+
+    if (u_layoutLarge)
+    {
+        uint16_t half = (v_screenSizeH >> 1);
+
+        // Block over both halves
+        if ((y1 < half) and (y2 >= half))
+        {
+            s_setBlock(x1, x2, y1, half - 1);
+            s_setBlock(x1, x2, half, y2);
+            return;
+        }
+
+        if (y1 >= half)
+        {
+            y0 = half; // rebase y1 and y2
+            y1 -= half;
+            y2 -= half;
+            z0 = (u_pageColourSize >> 1); // buffer second half
+        }
+        bytesH = (u_bufferSizeH >> 1);
+    }
+
+    uint8_t shift = (u_layout == LAYOUT_BWRY) ? 2 : 3; // 4 or 8 pixels per byte
+    uint8_t bits = (u_layout == LAYOUT_BWRY) ? 2 : 1; // 2 or 1 bit per pixel
+    uint8_t modulo = (1 << shift) - 1;
+
+    z0 += (uint32_t)x1 * bytesH;
+    uint16_t zStart = (y1 >> shift);
+    uint16_t zEnd = (y2 >> shift);
+    uint8_t maskStart = 0xff >> (bits * (y1 & modulo));
+    uint8_t maskEnd = 0xff << (8 - bits * ((y2 & modulo) + 1));
+    uint8_t pages = (u_layout == LAYOUT_BWR) ? 2 : 1;
+
+    if (zStart == zEnd)
+    {
+        maskStart &= maskEnd;
+    }
+
+    for (uint8_t page = 0; page < pages; page += 1)
+    {
+        FRAMEBUFFER_TYPE row = s_newImage + page * u_pageColourSize + z0;
+
+        for (uint16_t x = x1; x <= x2; x += 1)
+        {
+            // Combined colours alternate on even and odd rows
+            uint8_t pattern = u_penPattern[page][(x + y0) & 0x01];
+
+            row[zStart] = (row[zStart] & ~maskStart) | (pattern & maskStart);
+            if (zEnd > zStart)
             {
-                if (flagOdd)
+                if (zEnd > zStart + 1)
                 {
-                    colour = myColours.black; // black
-                }
-                else
-                {
-                    colour = myColours.white; // white
+                    memset(row + zStart + 1, pattern, zEnd - zStart - 1);
                 }
+                row[zEnd] = (row[zEnd] & ~maskEnd) | (pattern & maskEnd);
             }
+            row += bytesH;
+        }
+    }
+}
 
-            // Basic colours
-            if (colour == myColours.red)
-            {
-                // physical red 0-1
-                bitClear(s_newImage[z1], b1);
-                bitSet(s_newImage[u_pageColourSize + z1], b1);
-            }
-            else if (colour == myColours.white)
-            {
-                // physical black 0-0
-                bitClear(s_newImage[z1], b1);
-                bitClear(s_newImage[u_pageColourSize + z1], b1);
-            }
-            else if (colour == myColours.black)
-            {
-                // physical white 1-0
-                bitSet(s_newImage[z1], b1);
-                bitClear(s_newImage[u_pageColourSize + z1], b1);
-            }
-            break;
+void Screen_EPD::s_setRunStrided(uint16_t x1, uint16_t x2, uint16_t y1)
+{
+    uint32_t z0 = 0;
+    uint16_t bytesH = u_bufferSizeH;
+    uint16_t y0 = y1; // before rebase
+
+    if (u_layoutLarge)
+    {
+        if (y1 >= (v_screenSizeH >> 1))
+        {
+            y1 -= (v_screenSizeH >> 1); // rebase y1
+            z0 = (u_pageColourSize >> 1); // buffer second half
+        }
+        bytesH = (u_bufferSizeH >> 1);
+    }
+
+    uint8_t shift = (u_layout == LAYOUT_BWRY) ? 2 : 3; // 4 or 8 pixels per byte
+    uint8_t bits = (u_layout == LAYOUT_BWRY) ? 2 : 1; // 2 or 1 bit per pixel
+    uint8_t j = y1 & ((1 << shift) - 1); // position in byte
+
+    z0 += (uint32_t)x1 * bytesH + (y1 >> shift);
+    uint8_t mask = ((1 << bits) - 1) << (8 - bits * (j + 1));
+    uint8_t pages = (u_layout == LAYOUT_BWR) ? 2 : 1;
+
+    for (uint8_t page = 0; page < pages; page += 1)
+    {
+        FRAMEBUFFER_TYPE item = s_newImage + page * u_pageColourSize + z0;
+
+        // Combined colours alternate on even and odd x
+        uint8_t value[2];
+        value[0] = u_penPattern[page][(y0 + j) & 0x01] & mask;
+        value[1] = u_penPattern[page][(y0 + j + 1) & 0x01] & mask;
+
+        for (uint16_t x = x1; x <= x2; x += 1)
+        {
+            *item = (*item & ~mask) | value[x & 0x01];
+            item += bytesH;
+        }
+    }
+}
+
+void Screen_EPD::s_kernelBW(uint16_t x1, uint16_t y1, uint8_t code)
+{
+    uint32_t z1 = (uint32_t)x1 * u_bufferSizeH + (y1 >> 3); // 8 pixels per byte
+    uint8_t b1 = 7 - (y1 & 0x07);
+
+    if (code)
+    {
+        bitSet(s_newImage[z1], b1);
+    }
+    else
+    {
+        bitClear(s_newImage[z1], b1);
+    }
+}
+
+void Screen_EPD::s_kernelBWR(uint16_t x1, uint16_t y1, uint8_t code)
+{
+    uint32_t z1 = (uint32_t)x1 * u_bufferSizeH + (y1 >> 3); // 8 pixels per byte
+    uint8_t b1 = 7 - (y1 & 0x07);
+
+    if (code & 0b01)
+    {
+        bitSet(s_newImage[z1], b1);
+    }
+    else
+    {
+        bitClear(s_newImage[z1], b1);
+    }
+
+    if (code & 0b10)
+    {
+        bitSet(s_newImage[u_pageColourSize + z1], b1);
+    }
+    else
+    {
+        bitClear(s_newImage[u_pageColourSize + z1], b1);
+    }
+}
+
+void Screen_EPD::s_kernelBWRY(uint16_t x1, uint16_t y1, uint8_t code)
+{
+    uint32_t z1 = (uint32_t)x1 * u_bufferSizeH + (y1 >> 2); // 4 pixels per byte
+    uint8_t b1 = 6 - 2 * (y1 & 0x03);
+
+    s_newImage[z1] = (s_newImage[z1] & ~(0b11 << b1)) | (code << b1);
+}
+
+void Screen_EPD::s_kernelLargeBW(uint16_t x1, uint16_t y1, uint8_t code)
+{
+    uint32_t z1 = 0;
+    if (y1 >= (v_screenSizeH >> 1))
+    {
+        y1 -= (v_screenSizeH >> 1); // rebase y1
+        z1 += (u_pageColourSize >> 1); // buffer second half
+    }
+    z1 += (uint32_t)x1 * (u_bufferSizeH >> 1) + (y1 >> 3); // 8 pixels per byte
+    uint8_t b1 = 7 - (y1 & 0x07);
+
+    if (code)
+    {
+        bitSet(s_newImage[z1], b1);
+    }
+    else
+    {
+        bitClear(s_newImage[z1], b1);
+    }
+}
+
+void Screen_EPD::s_kernelLargeBWR(uint16_t x1, uint16_t y1, uint8_t code)
+{
+    uint32_t z1 = 0;
+    if (y1 >= (v_screenSizeH >> 1))
+    {
+        y1 -= (v_screenSizeH >> 1); // rebase y1
+        z1 += (u_pageColourSize >> 1); // buffer second half
+    }
+    z1 += (uint32_t)x1 * (u_bufferSizeH >> 1) + (y1 >> 3); // 8 pixels per byte
+    uint8_t b1 = 7 - (y1 & 0x07);
+
+    if (code & 0b01)
+    {
+        bitSet(s_newImage[z1], b1);
+    }
+    else
+    {
+        bitClear(s_newImage[z1], b1);
+    }
+
+    if (code & 0b10)
+    {
+        bitSet(s_newImage[u_pageColourSize + z1], b1);
+    }
+    else
+    {
+        bitClear(s_newImage[u_pageColourSize + z1], b1);
+    }
+}
+
+void Screen_EPD::s_kernelLargeBWRY(uint16_t x1, uint16_t y1, uint8_t code)
+{
+    uint32_t z1 = 0;
+    if (y1 >= (v_screenSizeH >> 1))
+    {
+        y1 -= (v_screenSizeH >> 1); // rebase y1
+        z1 += (u_pageColourSize >> 1); // buffer second half
     }
+    z1 += (uint32_t)x1 * (u_bufferSizeH >> 1) + (y1 >> 2); // 4 pixels per byte
+    uint8_t b1 = 6 - 2 * (y1 & 0x03);
+
+    s_newImage[z1] = (s_newImage[z1] & ~(0b11 << b1)) | (code << b1);
 }
 
 void Screen_EPD::s_setOrientation(uint8_t orientation)
@@ -841,87 +2560,425 @@ bool Screen_EPD::s_orientCoordinates(uint16_t & x, uint16_t & y)
             }
             break;
 
-        default: // checked
+        default: // checked
+
+            if ((x < v_screenSizeH) and (y < v_screenSizeV))
+            {
+                hV_HAL_swap(x, y);
+                _flagResult = RESULT_SUCCESS;
+            }
+            break;
+    }
+
+    // Physical line within the band
+    x -= u_bandFirst;
+    if (x >= u_bufferSizeV)
+    {
+        _flagResult = RESULT_ERROR;
+    }
+
+    return _flagResult;
+}
+
+uint32_t Screen_EPD::s_getZ(uint16_t x1, uint16_t y1)
+{
+    uint32_t z1 = 0;
+
+    switch (s_driver->d_COG)
+    {
+        case COG_BWRY_LARGE:
+
+            if (y1 >= (v_screenSizeH >> 1))
+            {
+                y1 -= (v_screenSizeH >> 1); // rebase y1
+                z1 += (u_pageColourSize >> 1); // buffer second half
+            }
+            z1 += (uint32_t)x1 * (u_bufferSizeH >> 1) + (y1 >> 2); // 4 pixels per byte
+            break;
+
+        case COG_BWRY_MEDIUM:
+        case COG_BWRY_SMALL:
+
+            z1 = (uint32_t)x1 * u_bufferSizeH + (y1 >> 2); // 4 pixels per byte
+
+            break;
+
+        case COG_FAST_LARGE:
+        case COG_WIDE_LARGE:
+        case COG_NORMAL_LARGE:
+
+            if (y1 >= (v_screenSizeH >> 1))
+            {
+                y1 -= (v_screenSizeH >> 1); // rebase y1
+                z1 += (u_pageColourSize >> 1); // buffer second half
+            }
+            z1 += (uint32_t)x1 * (u_bufferSizeH >> 1) + (y1 >> 3); // 8 pixels per byte
+            break;
+
+        default:
+
+            z1 = (uint32_t)x1 * u_bufferSizeH + (y1 >> 3); // 8 pixels per byte
+            break;
+    }
+
+    return z1;
+}
+
+uint16_t Screen_EPD::s_getB(uint16_t x1, uint16_t y1)
+{
+    uint16_t b1 = 0;
+
+    switch (s_driver->d_COG)
+    {
+        case COG_BWRY_LARGE:
+        case COG_BWRY_MEDIUM:
+        case COG_BWRY_SMALL:
+
+            b1 = 6 - 2 * (y1 % 4); // 4 pixels per byte
+            break;
+
+        default:
+
+            b1 = 7 - (y1 % 8); // 8 pixels per byte
+            break;
+    }
+    return b1;
+}
+
+uint16_t Screen_EPD::s_getPoint(uint16_t x1, uint16_t y1)
+{
+    // Band of external memory with the point
+    if ((u_memory != 0) and v_listRecord and (x1 < screenSizeX()) and (y1 < screenSizeY()))
+    {
+        uint16_t line = s_getLine(x1, y1);
+        s_loadBand(line - (line % u_bandLines));
+    }
+
+    // Orient and check coordinates are within screen
+    if (s_orientCoordinates(x1, y1) == RESULT_ERROR)
+    {
+        return 0x0000;
+    }
+
+    // Line of next frame-buffer not yet copied from previous
+    FRAMEBUFFER_TYPE image = (s_isStale(x1)) ? u_previousImage : s_newImage;
+    uint32_t z1 = s_getZ(x1, y1);
+    uint16_t b1 = s_getB(x1, y1);
+    uint16_t colour;
+
+    switch (u_layout)
+    {
+        case LAYOUT_BWRY:
+
+            switch ((image[z1] >> b1) & 0b11)
+            {
+                case 0b00:
+
+                    colour = myColours.black;
+                    break;
+
+                case 0b01:
+
+                    colour = myColours.white;
+                    break;
+
+                case 0b10:
+
+                    colour = myColours.yellow;
+                    break;
+
+                default:
+
+                    colour = myColours.red;
+                    break;
+            }
+            break;
+
+        case LAYOUT_BW:
+
+            colour = bitRead(image[z1], b1) ? myColours.black : myColours.white;
+            break;
+
+        default: // LAYOUT_BWR
 
-            if ((x < v_screenSizeH) and (y < v_screenSizeV))
+            if (bitRead(image[u_pageColourSize + z1], b1))
             {
-                hV_HAL_swap(x, y);
-                _flagResult = RESULT_SUCCESS;
+                colour = myColours.red;
+            }
+            else
+            {
+                colour = bitRead(image[z1], b1) ? myColours.black : myColours.white;
             }
             break;
     }
 
-    return _flagResult;
+    return colour;
 }
 
-uint32_t Screen_EPD::s_getZ(uint16_t x1, uint16_t y1)
+bool Screen_EPD::s_orientArea(uint16_t & x1, uint16_t & y1, uint16_t & x2, uint16_t & y2)
 {
-    uint32_t z1 = 0;
+    if (x1 > x2)
+    {
+        hV_HAL_swap(x1, x2);
+    }
+    if (y1 > y2)
+    {
+        hV_HAL_swap(y1, y2);
+    }
+    if ((x1 >= screenSizeX()) or (y1 >= screenSizeY()))
+    {
+        return RESULT_ERROR;
+    }
+    x2 = hV_HAL_min(x2, (uint16_t)(screenSizeX() - 1));
+    y2 = hV_HAL_min(y2, (uint16_t)(screenSizeY() - 1));
 
-    switch (s_driver->d_COG)
+    // Opposite corners, physical coordinates
+    s_orientCoordinates(x1, y1);
+    s_orientCoordinates(x2, y2);
+
+    if (x1 > x2)
     {
-        case COG_BWRY_LARGE:
+        hV_HAL_swap(x1, x2);
+    }
+    if (y1 > y2)
+    {
+        hV_HAL_swap(y1, y2);
+    }
 
-            if (y1 >= (v_screenSizeH >> 1))
-            {
-                y1 -= (v_screenSizeH >> 1); // rebase y1
-                z1 += (u_pageColourSize >> 1); // buffer second half
-            }
-            z1 += (uint32_t)x1 * (u_bufferSizeH >> 1) + (y1 >> 2); // 4 pixels per byte
-            break;
+    return RESULT_SUCCESS;
+}
 
-        case COG_BWRY_MEDIUM:
-        case COG_BWRY_SMALL:
+uint32_t Screen_EPD::s_getBit(uint16_t x1, uint16_t y1)
+{
+    uint8_t bits = (u_layout == LAYOUT_BWRY) ? 2 : 1; // 2 or 1 bit per pixel
 
-            z1 = (uint32_t)x1 * u_bufferSizeH + (y1 >> 2); // 4 pixels per byte
+    return (s_getZ(x1, y1) << 3) + (8 - bits - s_getB(x1, y1));
+}
 
-            break;
+uint8_t Screen_EPD::s_getBits8(int32_t bit)
+{
+    // End of the allocation, next frame-buffer may be the second page after swap
+    int32_t limit = (u_newFrameBuffer + u_pageColourSize * u_bufferDepth) - s_newImage;
+    int32_t z1 = bit >> 3; // arithmetic shift, rounded down
+    uint8_t shift = bit & 0x07;
+    uint8_t value = 0x00;
 
-        case COG_FAST_LARGE:
-        case COG_WIDE_LARGE:
-        case COG_NORMAL_LARGE:
+    if ((z1 >= 0) and (z1 < limit))
+    {
+        value = s_newImage[z1] << shift;
+    }
+    if ((shift > 0) and (z1 + 1 >= 0) and (z1 + 1 < limit))
+    {
+        value |= s_newImage[z1 + 1] >> (8 - shift);
+    }
+    return value;
+}
 
-            if (y1 >= (v_screenSizeH >> 1))
-            {
-                y1 -= (v_screenSizeH >> 1); // rebase y1
-                z1 += (u_pageColourSize >> 1); // buffer second half
-            }
-            z1 += (uint32_t)x1 * (u_bufferSizeH >> 1) + (y1 >> 3); // 8 pixels per byte
-            break;
+void Screen_EPD::s_moveBits(uint32_t sourceBit, uint32_t targetBit, uint32_t length)
+{
+    if ((length == 0) or (sourceBit == targetBit))
+    {
+        return;
+    }
 
-        default:
+    uint32_t zFirst = targetBit >> 3;
+    uint32_t zLast = (targetBit + length - 1) >> 3;
+    uint8_t maskFirst = 0xff >> (targetBit & 0x07);
+    uint8_t maskLast = 0xff << (7 - ((targetBit + length - 1) & 0x07));
+    int32_t delta = (int32_t)sourceBit - (int32_t)targetBit;
 
-            z1 = (uint32_t)x1 * u_bufferSizeH + (y1 >> 3); // 8 pixels per byte
-            break;
+    if (zFirst == zLast)
+    {
+        maskFirst &= maskLast;
     }
 
-    return z1;
+    // Same position in bytes, whole bytes moved
+    if ((delta & 0x07) == 0)
+    {
+        int32_t offset = delta >> 3;
+        uint8_t valueFirst = s_newImage[zFirst + offset];
+        uint8_t valueLast = s_newImage[zLast + offset];
+
+        if (zLast > zFirst + 1)
+        {
+            memmove(s_newImage + zFirst + 1, s_newImage + zFirst + 1 + offset, zLast - zFirst - 1);
+        }
+        s_newImage[zFirst] = (s_newImage[zFirst] & ~maskFirst) | (valueFirst & maskFirst);
+        if (zLast > zFirst)
+        {
+            s_newImage[zLast] = (s_newImage[zLast] & ~maskLast) | (valueLast & maskLast);
+        }
+        return;
+    }
+
+    // Bits shifted, bytes read before being written
+    int32_t z1 = (delta > 0) ? zFirst : zLast;
+    int32_t step = (delta > 0) ? 1 : -1;
+
+    for (uint32_t k = 0; k <= zLast - zFirst; k += 1)
+    {
+        uint8_t mask = 0xff;
+        if (z1 == (int32_t)zFirst)
+        {
+            mask &= maskFirst;
+        }
+        if (z1 == (int32_t)zLast)
+        {
+            mask &= maskLast;
+        }
+
+        uint8_t value = s_getBits8((z1 << 3) + delta);
+        s_newImage[z1] = (s_newImage[z1] & ~mask) | (value & mask);
+        z1 += step;
+    }
 }
 
-uint16_t Screen_EPD::s_getB(uint16_t x1, uint16_t y1)
+bool Screen_EPD::s_operateBlock(uint16_t x1, uint16_t x2, uint16_t y1, uint16_t y2, uint8_t operation)
 {
-    uint16_t b1 = 0;
+    uint32_t z0 = 0;
+    uint16_t bytesH = u_bufferSizeH;
+    uint16_t y0 = 0; // rebase
 
-    switch (s_driver->d_COG)
+    if (u_layoutLarge)
     {
-        case COG_BWRY_LARGE:
-        case COG_BWRY_MEDIUM:
-        case COG_BWRY_SMALL:
+        uint16_t half = (v_screenSizeH >> 1);
 
-            b1 = 6 - 2 * (y1 % 4); // 4 pixels per byte
-            break;
+        // Block over both halves
+        if ((y1 < half) and (y2 >= half))
+        {
+            bool flagFirst = s_operateBlock(x1, x2, y1, half - 1, operation);
+            if (flagFirst and (operation == OPERATION_COMPARE))
+            {
+                return true;
+            }
+            return s_operateBlock(x1, x2, half, y2, operation);
+        }
 
-        default:
+        if (y1 >= half)
+        {
+            y0 = half; // rebase y1 and y2
+            y1 -= half;
+            y2 -= half;
+            z0 = (u_pageColourSize >> 1); // buffer second half
+        }
+        bytesH = (u_bufferSizeH >> 1);
+    }
 
-            b1 = 7 - (y1 % 8); // 8 pixels per byte
-            break;
+    uint8_t shift = (u_layout == LAYOUT_BWRY) ? 2 : 3; // 4 or 8 pixels per byte
+    uint8_t bits = (u_layout == LAYOUT_BWRY) ? 2 : 1; // 2 or 1 bit per pixel
+    uint8_t modulo = (1 << shift) - 1;
+
+    z0 += (uint32_t)x1 * bytesH;
+    uint16_t zStart = (y1 >> shift);
+    uint16_t zEnd = (y2 >> shift);
+    uint8_t maskStart = 0xff >> (bits * (y1 & modulo));
+    uint8_t maskEnd = 0xff << (8 - bits * ((y2 & modulo) + 1));
+
+    // Invert reads the red page but writes the black page only, swap reads and writes both
+    uint8_t pages = ((u_layout == LAYOUT_BWR) and (operation == OPERATION_COMPARE)) ? 2 : 1;
+    uint8_t white = (u_layout == LAYOUT_BWRY) ? 0x55 : 0x00; // physical code of white
+    uint8_t flagWhite, flagPen;
+
+    for (uint8_t page = 0; page < pages; page += 1)
+    {
+        uint32_t offset = page * u_pageColourSize + z0;
+
+        for (uint16_t x = x1; x <= x2; x += 1)
+        {
+            // Compare reads previous frame-buffer for lines not yet copied
+            FRAMEBUFFER_TYPE image = ((operation == OPERATION_COMPARE) and s_isStale(x)) ? u_previousImage : s_newImage;
+            FRAMEBUFFER_TYPE row = image + offset;
+
+            // Combined colours alternate on even and odd rows
+            uint8_t pattern = u_penPattern[page][(x + y0) & 0x01];
+            uint8_t patternRed = u_penPattern[1][(x + y0) & 0x01]; // second page, LAYOUT_BWR
+
+            for (uint16_t z = zStart; z <= zEnd; z += 1)
+            {
+                uint8_t mask = 0xff;
+                if (z == zStart)
+                {
+                    mask &= maskStart;
+                }
+                if (z == zEnd)
+                {
+                    mask &= maskEnd;
+                }
+
+                switch (operation)
+                {
+                    case OPERATION_SWAP:
+
+                        // Pixels equal to white or to pen, swapped
+                        switch (u_layout)
+                        {
+                            case LAYOUT_BWRY:
+
+                                // 2 bits per pixel, equal if both bits equal
+                                flagWhite = row[z] ^ white;
+                                flagPen = row[z] ^ pattern;
+                                flagWhite = ~(flagWhite | (flagWhite >> 1)) & 0x55;
+                                flagPen = ~(flagPen | (flagPen >> 1)) & 0x55;
+                                flagWhite = (flagWhite | (flagWhite << 1)) & mask;
+                                flagPen = (flagPen | (flagPen << 1)) & mask;
+                                row[z] = (row[z] & ~(flagWhite | flagPen)) | (pattern & flagWhite) | (white & flagPen);
+                                break;
+
+                            case LAYOUT_BW:
+
+                                flagWhite = ~row[z] & mask;
+                                flagPen = ~(row[z] ^ pattern) & mask;
+                                row[z] = (row[z] & ~(flagWhite | flagPen)) | (pattern & flagWhite);
+                                break;
+
+                            default: // LAYOUT_BWR
+
+                                // Pixel on both pages, white = 0-0
+                                flagWhite = ~(row[z] | row[u_pageColourSize + z]) & mask;
+                                flagPen = ~((row[z] ^ pattern) | (row[u_pageColourSize + z] ^ patternRed)) & mask;
+                                row[z] = (row[z] & ~(flagWhite | flagPen)) | (pattern & flagWhite);
+                                row[u_pageColourSize + z] = (row[u_pageColourSize + z] & ~(flagWhite | flagPen)) | (patternRed & flagWhite);
+                                break;
+                        }
+                        break;
+
+                    case OPERATION_COMPARE:
+
+                        if ((row[z] ^ pattern) & mask)
+                        {
+                            return true;
+                        }
+                        break;
+
+                    default: // OPERATION_INVERT
+
+                        switch (u_layout)
+                        {
+                            case LAYOUT_BWRY:
+
+                                // Black 00 and white 01 only, high bit clear
+                                row[z] ^= ~(row[z] >> 1) & 0x55 & mask;
+                                break;
+
+                            case LAYOUT_BW:
+
+                                row[z] ^= mask;
+                                break;
+
+                            default: // LAYOUT_BWR
+
+                                // Red page unchanged
+                                row[z] ^= ~row[u_pageColourSize + z] & mask;
+                                break;
+                        }
+                        break;
+                }
+            }
+            offset += bytesH;
+        }
     }
-    return b1;
-}
 
-uint16_t Screen_EPD::s_getPoint(uint16_t x1, uint16_t y1)
-{
-    return 0x0000;
+    return false;
 }
 //
 // === End of Protected section
@@ -1075,6 +3132,261 @@ uint8_t Screen_EPD::checkTemperatureMode(uint8_t updateMode)
 // === End of Temperature section
 //
 
+//
+// === Area section
+//
+void Screen_EPD::invert(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2)
+{
+    if ((u_memory != 0) and v_listRecord)
+    {
+        s_operateMemory(x1, y1, x2, y2, OPERATION_INVERT, 0);
+        return;
+    }
+
+    if ((s_clipArea(x1, y1, x2, y2) == RESULT_ERROR) or (s_orientArea(x1, y1, x2, y2) == RESULT_ERROR))
+    {
+        return;
+    }
+
+    s_syncLines(x1, x2);
+    s_operateBlock(x1, x2, y1, y2, OPERATION_INVERT);
+}
+
+void Screen_EPD::highlight(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2, uint16_t colour)
+{
+    if ((u_memory != 0) and v_listRecord)
+    {
+        s_operateMemory(x1, y1, x2, y2, OPERATION_SWAP, colour);
+        return;
+    }
+
+    if ((s_clipArea(x1, y1, x2, y2) == RESULT_ERROR) or (s_orientArea(x1, y1, x2, y2) == RESULT_ERROR))
+    {
+        return;
+    }
+
+    // White swapped with itself
+    if (colour == myColours.white)
+    {
+        return;
+    }
+
+    if (colour != u_penColour)
+    {
+        s_setPen(colour);
+    }
+    if ((u_penCode[0] == PEN_NONE) or (u_penEntry != 0))
+    {
+        return;
+    }
+
+    s_syncLines(x1, x2);
+    s_operateBlock(x1, x2, y1, y2, OPERATION_SWAP);
+}
+
+bool Screen_EPD::isClear(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2, uint16_t colour)
+{
+    if ((u_memory != 0) and v_listRecord)
+    {
+        return s_operateMemory(x1, y1, x2, y2, OPERATION_COMPARE, colour);
+    }
+
+    // Current band only, other bands not in the frame-buffer
+    if ((u_bandLines > 0) and (u_memory == 0))
+    {
+        uint16_t oldClip[4] = { v_clipX1, v_clipY1, v_clipX2, v_clipY2 };
+        v_clipX1 = 0;
+        v_clipY1 = 0;
+        v_clipX2 = screenSizeX() - 1;
+        v_clipY2 = screenSizeY() - 1;
+        s_clipBand();
+        bool result = s_clipArea(x1, y1, x2, y2);
+        v_clipX1 = oldClip[0];
+        v_clipY1 = oldClip[1];
+        v_clipX2 = oldClip[2];
+        v_clipY2 = oldClip[3];
+
+        if (result == RESULT_ERROR)
+        {
+            return true; // nothing to check
+        }
+    }
+
+    if (s_orientArea(x1, y1, x2, y2) == RESULT_ERROR)
+    {
+        return true; // nothing to check
+    }
+
+    if (colour != u_penColour)
+    {
+        s_setPen(colour);
+    }
+    if ((u_penCode[0] == PEN_NONE) or (u_penEntry != 0))
+    {
+        return false;
+    }
+
+    return (s_operateBlock(x1, x2, y1, y2, OPERATION_COMPARE) == false);
+}
+
+void Screen_EPD::copyArea(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2, uint16_t x0, uint16_t y0)
+{
+    // Other bands not in the frame-buffer
+    if (u_bandLines > 0)
+    {
+        hV_HAL_log(LEVEL_ERROR, "Copy area not available with bands");
+        return;
+    }
+
+    if (x1 > x2)
+    {
+        hV_HAL_swap(x1, x2);
+    }
+    if (y1 > y2)
+    {
+        hV_HAL_swap(y1, y2);
+    }
+    if ((x1 >= screenSizeX()) or (y1 >= screenSizeY()) or (x0 >= screenSizeX()) or (y0 >= screenSizeY()))
+    {
+        return;
+    }
+
+    // Clip source and destination
+    uint16_t dx = hV_HAL_min(x2, (uint16_t)(screenSizeX() - 1)) - x1;
+    uint16_t dy = hV_HAL_min(y2, (uint16_t)(screenSizeY() - 1)) - y1;
+    dx = hV_HAL_min(dx, (uint16_t)(screenSizeX() - 1 - x0));
+    dy = hV_HAL_min(dy, (uint16_t)(screenSizeY() - 1 - y0));
+
+    // Translation, physical coordinates
+    uint16_t sx1 = x1, sy1 = y1, tx1 = x0, ty1 = y0;
+    s_orientCoordinates(sx1, sy1);
+    s_orientCoordinates(tx1, ty1);
+    int32_t deltaX = (int32_t)tx1 - sx1;
+    int32_t deltaY = (int32_t)ty1 - sy1;
+
+    // Source, physical coordinates
+    x2 = x1 + dx;
+    y2 = y1 + dy;
+    s_orientArea(x1, y1, x2, y2);
+
+    // Source and target lines
+    s_syncLines(hV_HAL_min(x1, (uint16_t)(x1 + deltaX)), hV_HAL_max(x2, (uint16_t)(x2 + deltaX)));
+
+    uint8_t pages = (u_layout == LAYOUT_BWR) ? 2 : 1;
+    uint8_t bits = (u_layout == LAYOUT_BWRY) ? 2 : 1; // 2 or 1 bit per pixel
+
+    // Segments of y within one half for source and target
+    uint16_t breaks[4] = { y1, (uint16_t)(y2 + 1), (uint16_t)(y2 + 1), (uint16_t)(y2 + 1) };
+    uint8_t segments = 1;
+    if (u_layoutLarge)
+    {
+        int32_t half = (v_screenSizeH >> 1);
+        int32_t points[2] = { half, half - deltaY };
+        if (points[0] > points[1])
+        {
+            hV_HAL_swap(points[0], points[1]);
+        }
+
+        for (uint8_t k = 0; k < 2; k += 1)
+        {
+            if ((points[k] > breaks[segments - 1]) and (points[k] <= y2))
+            {
+                breaks[segments] = points[k];
+                segments += 1;
+                breaks[segments] = y2 + 1;
+            }
+        }
+    }
+
+    // Order rows and segments so that sources are read before being overwritten
+    for (uint16_t i = 0; i <= x2 - x1; i += 1)
+    {
+        uint16_t x = (deltaX > 0) ? x2 - i : x1 + i;
+
+        for (uint8_t j = 0; j < segments; j += 1)
+        {
+            uint8_t segment = (deltaY > 0) ? segments - 1 - j : j;
+            uint16_t yStart = breaks[segment];
+            uint16_t length = breaks[segment + 1] - yStart;
+
+            uint32_t sourceBit = s_getBit(x, yStart);
+            uint32_t targetBit = s_getBit(x + deltaX, yStart + deltaY);
+
+            for (uint8_t page = 0; page < pages; page += 1)
+            {
+                uint32_t offset = (page * u_pageColourSize) << 3;
+                s_moveBits(sourceBit + offset, targetBit + offset, length * bits);
+            }
+        }
+    }
+}
+
+bool Screen_EPD::scroll(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2, int16_t dx, int16_t dy, uint16_t colour)
+{
+    // Other bands not in the frame-buffer, content neither moved nor erased
+    if (u_bandLines > 0)
+    {
+        hV_HAL_log(LEVEL_ERROR, "Scroll not available with bands");
+        return RESULT_ERROR;
+    }
+
+    if (x1 > x2)
+    {
+        hV_HAL_swap(x1, x2);
+    }
+    if (y1 > y2)
+    {
+        hV_HAL_swap(y1, y2);
+    }
+    if ((x1 >= screenSizeX()) or (y1 >= screenSizeY()))
+    {
+        return RESULT_SUCCESS; // nothing to scroll
+    }
+    x2 = hV_HAL_min(x2, (uint16_t)(screenSizeX() - 1));
+    y2 = hV_HAL_min(y2, (uint16_t)(screenSizeY() - 1));
+
+    uint16_t absoluteX = (dx < 0) ? -dx : dx;
+    uint16_t absoluteY = (dy < 0) ? -dy : dy;
+
+    // Whole area uncovered
+    if ((absoluteX > x2 - x1) or (absoluteY > y2 - y1))
+    {
+        s_setRectangle(x1, y1, x2, y2, colour);
+        return RESULT_SUCCESS;
+    }
+
+    // Remaining content
+    uint16_t sx1 = (dx < 0) ? x1 + absoluteX : x1;
+    uint16_t sy1 = (dy < 0) ? y1 + absoluteY : y1;
+    uint16_t sx2 = (dx < 0) ? x2 : x2 - absoluteX;
+    uint16_t sy2 = (dy < 0) ? y2 : y2 - absoluteY;
+    copyArea(sx1, sy1, sx2, sy2, sx1 + dx, sy1 + dy);
+
+    // Uncovered area
+    if (dx > 0)
+    {
+        s_setRectangle(x1, y1, x1 + absoluteX - 1, y2, colour);
+    }
+    else if (dx < 0)
+    {
+        s_setRectangle(x2 - absoluteX + 1, y1, x2, y2, colour);
+    }
+
+    if (dy > 0)
+    {
+        s_setRectangle(x1, y1, x2, y1 + absoluteY - 1, colour);
+    }
+    else if (dy < 0)
+    {
+        s_setRectangle(x1, y2 - absoluteY + 1, x2, y2, colour);
+    }
+
+    return RESULT_SUCCESS;
+}
+//
+// === End of Area section
+//
+
 //
 // === Miscellaneous section
 //
@@ -1171,6 +3483,41 @@ STRING_TYPE Screen_EPD::WhoAmI()
     return formatString("iTC %i.%02i\"%s", v_screenDiagonal / 100, v_screenDiagonal % 100, work);
 }
 
+void Screen_EPD::setDither(uint8_t size)
+{
+    switch (size)
+    {
+        case DITHER_NEAREST:
+        case DITHER_2X2:
+        case DITHER_4X4:
+        case DITHER_8X8:
+
+            u_ditherSize = size;
+            break;
+
+        default:
+
+            u_ditherSize = DITHER_NONE;
+            break;
+    }
+
+    // After begin()
+    if (u_layout != 0)
+    {
+        if (u_ditherSize != DITHER_NONE)
+        {
+            s_setDitherTable();
+        }
+        s_setPen(u_penColour);
+        u_glyphPen = false;
+    }
+}
+
+uint8_t Screen_EPD::getDither()
+{
+    return u_ditherSize;
+}
+
 STRING_CONST_TYPE Screen_EPD::reference()
 {
     return formatString("%s v%i.%i.%i", SCREEN_EPD_VARIANT, SCREEN_EPD_RELEASE / 100, (SCREEN_EPD_RELEASE / 10) % 10, SCREEN_EPD_RELEASE % 10);
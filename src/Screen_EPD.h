@@ -54,15 +54,83 @@
 ///
 /// @brief Library release number
 ///
-#define SCREEN_EPD_RELEASE 1008
+#define SCREEN_EPD_RELEASE 1009
 
 #include "Driver_EPD_Virtual.h"
+#include "hV_Memory.h"
 
 ///
 /// @brief Library variant
 ///
 #define SCREEN_EPD_VARIANT "Basic"
 
+///
+/// @name Frame-buffer layouts
+/// @{
+#define LAYOUT_BW 0x01 ///< Black-white, 1 bit per pixel, 1 page, and 1 page for previous image with fast update
+#define LAYOUT_BWR 0x02 ///< Black-white-red, 1 bit per pixel, 2 pages
+#define LAYOUT_BWRY 0x04 ///< Black-white-red-yellow, 2 bits per pixel, 1 page
+/// @}
+
+///
+/// @brief Physical code for unsupported colour
+///
+#define PEN_NONE 0xff
+
+///
+/// @name Operations on blocks
+/// @{
+#define OPERATION_INVERT 1 ///< Swap black and white
+#define OPERATION_SWAP 2 ///< Swap pen and white
+#define OPERATION_COMPARE 3 ///< Compare with pen
+/// @}
+
+///
+/// @name Dithering for colours other than the screen colours
+/// @{
+#define DITHER_NONE 0 ///< No dithering, other colours ignored
+#define DITHER_NEAREST 1 ///< Nearest screen colour
+#define DITHER_2X2 2 ///< Ordered dithering, Bayer matrix 2x2
+#define DITHER_4X4 4 ///< Ordered dithering, Bayer matrix 4x4
+#define DITHER_8X8 8 ///< Ordered dithering, Bayer matrix 8x8
+/// @}
+
+///
+/// @brief Size of the display list for one command with external memory, in bytes
+/// @note Longer commands ignored with an error, see Screen_EPD::setExternalMemory()
+/// @note With 512 bytes, text up to 240 characters and polygons up to 122 points
+///
+#ifndef MEMORY_COMMAND_SIZE
+#define MEMORY_COMMAND_SIZE 512
+#endif // MEMORY_COMMAND_SIZE
+
+///
+/// @brief Size of the constant zero page for monochrome mode, in bytes
+/// @note 0 = no zero page and no monochrome mode, default
+/// @note Set at build time, for example `-DZERO_PAGE_SIZE=48000`, see README.md
+/// @note At least one page, half a page for large screens, 48000 for all screens
+/// @note Constant, in flash on most boards, only compiled if not 0
+///
+#ifndef ZERO_PAGE_SIZE
+#define ZERO_PAGE_SIZE 0
+#endif // ZERO_PAGE_SIZE
+
+///
+/// @brief Number of glyphs in the glyph cache
+/// @note Direct-mapped on the character, 4 bytes per row of pixels
+/// @note Allocated on the first text, GLYPH_CACHE_SLOTS * 4 * max(width, height) bytes, 6 KB for Terminal16x24 with 64 slots
+/// @note 0 = no cache, for example with bands or external memory on boards with little RAM
+///
+#ifndef GLYPH_CACHE_SLOTS
+#define GLYPH_CACHE_SLOTS 64
+#endif // GLYPH_CACHE_SLOTS
+
+///
+/// @brief Number of groups of physical lines copied from previous frame-buffer, fast update
+/// @note One bit per group, lines per group set by the size of the screen
+///
+#define STALE_GROUPS 128
+
 // Objects
 //
 ///
@@ -81,18 +149,37 @@ class Screen_EPD final : public hV_Screen_Buffer
     ///
     /// @brief Constructor with default pins
     /// @param driver &driver to link Screen_EPD to
-    /// @note Frame-buffer generated by the class
-    /// @note To be used with begin() with no parameter
+    /// @note Frame-buffer generated by the class with begin(), or supplied by the caller with begin(buffer, size)
     ///
     Screen_EPD(Driver_EPD_Virtual * driver);
 
     ///
     /// @brief Initialisation
     /// @note Frame-buffer generated internally, not suitable for FRAM
+    /// @note Frame-buffer of a previous begin() reused if large enough, released otherwise
     /// @warning begin() initialises GPIOs and reads OTP
     ///
     void begin();
 
+    ///
+    /// @brief Initialisation with a frame-buffer supplied by the caller
+    /// @param buffer frame-buffer, aligned on 4 bytes, for example from a static arena or DMA-capable memory
+    /// @param size size of the frame-buffer, in bytes
+    /// @return `RESULT_SUCCESS` = false = success, `RESULT_ERROR` = true = error, frame-buffer not aligned or too small
+    /// @note Size required: one page per colour or per frame, logged when too small
+    /// @note Frame-buffer generated internally by a previous begin() released
+    /// @warning Frame-buffer owned by the caller, not released by end()
+    /// @warning After an error, begin() required before drawing
+    ///
+    bool begin(FRAMEBUFFER_TYPE buffer, uint32_t size);
+
+    ///
+    /// @brief Release the frame-buffer, the glyph cache and the display list
+    /// @note Frame-buffer supplied by the caller left to the caller
+    /// @note begin() required before drawing again
+    ///
+    void end();
+
     ///
     /// @brief Clear the screen
     /// @param colour default = white
@@ -105,6 +192,7 @@ class Screen_EPD final : public hV_Screen_Buffer
     /// @note
     /// 1. Send the frame-buffer to the screen
     /// 2. Refresh the screen
+    /// @note With embedded fast update, identical frames are skipped
     /// @warning When normal update not available, proxy for fast update
     ///
     void flush();
@@ -114,10 +202,70 @@ class Screen_EPD final : public hV_Screen_Buffer
     /// @note
     /// 1. Send the frame-buffer to the screen
     /// 2. Refresh the screen
-    /// 3. Copy next frame-buffer into old frame-buffer
+    /// 3. Swap next and old frame-buffers, lines copied back on first drawing
+    /// @return number of bytes changed, `0` when the update is skipped
+    /// @note With embedded fast update, identical frames are skipped: no transfer, no refresh, no resume and suspend
+    /// @note Number of bytes sent per page instead for the first update, and for screens without embedded fast update
     /// @warning When fast update not available, proxy for normal update
     ///
-    void flushFast();
+    uint32_t flushFast();
+
+    ///
+    /// @brief Render callback for banded rendering
+    /// @param screen &screen to draw on
+    ///
+    typedef void (*bandRender_t)(Screen_EPD * screen);
+
+    ///
+    /// @brief Output callback for banded rendering
+    /// @param page colour page, `0` or `1` for the second page of black-white-red screens
+    /// @param offset position of the data in the page, in bytes
+    /// @param data frame-buffer data
+    /// @param size size of the data, in bytes
+    ///
+    typedef void (*bandOutput_t)(uint8_t page, uint32_t offset, const uint8_t * data, uint32_t size);
+
+    ///
+    /// @brief Set banded rendering
+    /// @param bandSize size of the band frame-buffer, in bytes, `0` = whole frame-buffer
+    /// @param render function drawing the whole screen, called once per band, nullptr = replay of the display list
+    /// @param output function receiving the pages of each band, in order
+    /// @note To be called before begin()
+    /// @note flush() and flushFast() draw each band with render and pass it to output
+    /// @note Bands of a multiple of 8 physical lines, at least 8 lines
+    /// @note Orientation, pen and font set before flush() restored for each band
+    /// @warning The panel is not refreshed by the library: the driver requires the whole frame-buffer, output is in charge of the transfer
+    /// @warning Not available with fast-update screens, as fast update requires the previous page of the whole frame-buffer
+    /// @warning Drawing outside render limited to the first band, copyArea(), scroll() and regenerate() not available
+    ///
+    void setBands(uint32_t bandSize, bandRender_t render, bandOutput_t output);
+
+    ///
+    /// @brief Set monochrome mode for normal-update screens
+    /// @param flag true = black and white only, false = default
+    /// @note To be called before begin()
+    /// @note One page instead of two, second page sent from a constant zero page
+    /// @note Red and dark or light red drawn as nothing, or dithered into black and white
+    /// @note Ignored by fast-update and black-white-red-yellow screens, or if page larger than ZERO_PAGE_SIZE
+    /// @warning ZERO_PAGE_SIZE to be defined at build time, as monochrome mode is disabled by default
+    ///
+    void setMonochrome(bool flag = true);
+
+    ///
+    /// @brief Set external memory for the frame-buffer
+    /// @param memory &external memory, for example an SPI SRAM, with all the pages of the frame-buffer
+    /// @param cacheSize size of the cache of physical lines in internal RAM, in bytes, `0` = 8 lines
+    /// @param output function receiving the pages read from external memory, in chunks of the cache size
+    /// @note To be called before begin()
+    /// @note Memory of one page per colour, screenSizeX() * screenSizeY() / 8 bytes per page, 2 bits per pixel for black-white-red-yellow screens
+    /// @note Each command drawn into the cached lines it covers, lines written back to external memory only when another band is required
+    /// @note flush() and flushFast() pass the pages to output, chunk by chunk
+    /// @note Each command recorded in MEMORY_COMMAND_SIZE bytes first, longer text and polygons with more points ignored with an error
+    /// @warning The panel is not refreshed by the library: the driver requires the whole frame-buffer, output is in charge of the transfer
+    /// @warning Not available with fast-update screens, as fast update requires the previous page of the whole frame-buffer
+    /// @warning copyArea(), scroll(), regenerate() and the display list not available
+    ///
+    void setExternalMemory(Memory_Virtual * memory, uint32_t cacheSize, bandOutput_t output);
 
     ///
     /// @brief Regenerate the panel
@@ -198,6 +346,88 @@ class Screen_EPD final : public hV_Screen_Buffer
     // === End of Temperature section
     //
 
+    //
+    // === Area section
+    //
+    ///
+    /// @brief Invert area
+    /// @param x1 top left coordinate, x-axis
+    /// @param y1 top left coordinate, y-axis
+    /// @param x2 bottom right coordinate, x-axis
+    /// @param y2 bottom right coordinate, y-axis
+    /// @note Black and white swapped, red and yellow unchanged
+    /// @note Area clipped to the clip rectangle
+    ///
+    /// @n @b More: @ref Coordinate
+    ///
+    void invert(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2);
+
+    ///
+    /// @brief Highlight area by swapping colour and white
+    /// @param x1 top left coordinate, x-axis
+    /// @param y1 top left coordinate, y-axis
+    /// @param x2 bottom right coordinate, x-axis
+    /// @param y2 bottom right coordinate, y-axis
+    /// @param colour 16-bit colour, default = black
+    /// @note White pixels set to colour, pixels of colour set to white, other colours unchanged, same call again to restore
+    /// @note Screen and combined colours other than white only
+    /// @note Area clipped to the clip rectangle
+    ///
+    /// @n @b More: @ref Coordinate, @ref Colour
+    ///
+    void highlight(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2, uint16_t colour = myColours.black);
+
+    ///
+    /// @brief Check area is clear
+    /// @param x1 top left coordinate, x-axis
+    /// @param y1 top left coordinate, y-axis
+    /// @param x2 bottom right coordinate, x-axis
+    /// @param y2 bottom right coordinate, y-axis
+    /// @param colour 16-bit colour, default = white
+    /// @return true if all the pixels of the area are of colour
+    /// @note Screen and combined colours only, false otherwise
+    /// @note With bands, pixels of the current band only
+    ///
+    /// @n @b More: @ref Coordinate, @ref Colour
+    ///
+    bool isClear(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2, uint16_t colour = myColours.white);
+
+    ///
+    /// @brief Copy area
+    /// @param x1 top left coordinate of the source, x-axis
+    /// @param y1 top left coordinate of the source, y-axis
+    /// @param x2 bottom right coordinate of the source, x-axis
+    /// @param y2 bottom right coordinate of the source, y-axis
+    /// @param x0 top left coordinate of the destination, x-axis
+    /// @param y0 top left coordinate of the destination, y-axis
+    /// @note Source and destination may overlap
+    /// @note Area clipped to the screen for source and destination
+    /// @note Not available with bands or external memory
+    ///
+    /// @n @b More: @ref Coordinate
+    ///
+    void copyArea(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2, uint16_t x0, uint16_t y0);
+
+    ///
+    /// @brief Scroll area
+    /// @param x1 top left coordinate, x-axis
+    /// @param y1 top left coordinate, y-axis
+    /// @param x2 bottom right coordinate, x-axis
+    /// @param y2 bottom right coordinate, y-axis
+    /// @param dx shift, x-axis, negative = left
+    /// @param dy shift, y-axis, negative = up
+    /// @param colour 16-bit colour for the uncovered area, default = white
+    /// @return `RESULT_SUCCESS` = false = success, `RESULT_ERROR` = true = error
+    /// @note Content moved out of the area is lost
+    /// @note Not available with bands or external memory, area left unchanged
+    ///
+    /// @n @b More: @ref Coordinate, @ref Colour
+    ///
+    bool scroll(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2, int16_t dx, int16_t dy, uint16_t colour = myColours.white);
+    //
+    // === End of Area section
+    //
+
     //
     // === Miscellaneous section
     //
@@ -225,6 +455,21 @@ class Screen_EPD final : public hV_Screen_Buffer
     ///
     uint8_t screenColours();
 
+    ///
+    /// @brief Set dithering for colours other than the screen colours
+    /// @param size default = `DITHER_4X4`, otherwise `DITHER_NONE`, `DITHER_NEAREST`, `DITHER_2X2` or `DITHER_8X8`
+    /// @note Default at start-up = `DITHER_NONE`, colours not supported by the screen are ignored
+    /// @note Screen colours and combined colours are not affected
+    /// @note Colours are quantised with RGB 3-3-2 look-up table, built by setDither()
+    ///
+    void setDither(uint8_t size = DITHER_4X4);
+
+    ///
+    /// @brief Get dithering
+    /// @return size set by setDither()
+    ///
+    uint8_t getDither();
+
     ///
     /// @brief Screen number
     /// @return Screen number as string
@@ -271,19 +516,263 @@ class Screen_EPD final : public hV_Screen_Buffer
     ///
     void s_setPoint(uint16_t x1, uint16_t y1, uint16_t colour);
 
+    ///
+    /// @brief Set point already clipped
+    /// @param x1 x coordinate, within screen
+    /// @param y1 y coordinate, within screen
+    /// @param colour 16-bit colour
+    /// @note Oriented without check
+    /// @n @b More: @ref Colour, @ref Coordinate
+    ///
+    void s_setPointInside(uint16_t x1, uint16_t y1, uint16_t colour);
+
+    ///
+    /// @brief Set span, x-axis
+    /// @param x1 first point coordinate, x-axis
+    /// @param x2 last point coordinate, x-axis
+    /// @param y1 point coordinate, y-axis
+    /// @param colour 16-bit colour
+    /// @n @b More: @ref Colour, @ref Coordinate
+    ///
+    void s_setSpanX(uint16_t x1, uint16_t x2, uint16_t y1, uint16_t colour);
+
+    ///
+    /// @brief Set span, y-axis
+    /// @param x1 point coordinate, x-axis
+    /// @param y1 first point coordinate, y-axis
+    /// @param y2 last point coordinate, y-axis
+    /// @param colour 16-bit colour
+    /// @n @b More: @ref Colour, @ref Coordinate
+    ///
+    void s_setSpanY(uint16_t x1, uint16_t y1, uint16_t y2, uint16_t colour);
+
+    ///
+    /// @brief Set solid rectangle
+    /// @param x1 top left coordinate, x-axis
+    /// @param y1 top left coordinate, y-axis
+    /// @param x2 bottom right coordinate, x-axis
+    /// @param y2 bottom right coordinate, y-axis
+    /// @param colour 16-bit colour
+    /// @n @b More: @ref Colour, @ref Coordinate
+    ///
+    void s_setRectangle(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2, uint16_t colour);
+
+    ///
+    /// @brief Set bitmap
+    /// @param x0 top left coordinate, x-axis
+    /// @param y0 top left coordinate, y-axis
+    /// @param bitmap rows of pixels, each row padded to a full byte
+    /// @param width size of the bitmap, x-axis
+    /// @param height size of the bitmap, y-axis
+    /// @param format `BITMAP_1BPP`, `BITMAP_2BPP` or `BITMAP_RGB565`
+    /// @param palette colours for indexes, `BITMAP_1BPP` and `BITMAP_2BPP` only
+    /// @param flagTransparent true = transparent index or colour not drawn
+    /// @param transparent index for `BITMAP_1BPP` and `BITMAP_2BPP`, colour for `BITMAP_RGB565`
+    /// @note Bytes written directly when rows are aligned on frame-buffer bytes, otherwise pixel by pixel
+    /// @n @b More: @ref Colour, @ref Coordinate
+    ///
+    void s_setBitmap(uint16_t x0, uint16_t y0, const uint8_t * bitmap, uint16_t width, uint16_t height,
+                     uint8_t format, const uint16_t * palette, bool flagTransparent, uint16_t transparent);
+
+    ///
+    /// @brief Set character
+    /// @param x0 top left coordinate, x-axis
+    /// @param y0 top left coordinate, y-axis
+    /// @param glyph index of the glyph in the font, from f_getGlyph()
+    /// @param textColour 16-bit colour for text
+    /// @param backColour 16-bit colour for background, only with solid font
+    /// @note Glyph from the cache written row by row with masks, text and background in one pass
+    /// @note Pixel by pixel for combined or dithered colours, or for glyphs not fully within screen
+    /// @n @b More: @ref Colour, @ref Coordinate
+    ///
+    void s_setCharacter(uint16_t x0, uint16_t y0, uint16_t glyph, uint16_t textColour, uint16_t backColour);
+
+    ///
+    /// @brief Get glyph from the cache
+    /// @param glyph index of the glyph in the font
+    /// @return rows of the glyph along the physical x-axis, first pixel on bit 31, 0 if no cache
+    /// @note Glyph transposed for the current font and orientation on first use
+    /// @note Always 0 when GLYPH_CACHE_SLOTS is 0
+    ///
+    uint32_t * s_getGlyph(uint16_t glyph);
+
     /// @brief Get point
     /// @param x1 x coordinate
     /// @param y1 y coordinate
-    /// @return colour 16-bit colour
+    /// @return colour 16-bit colour, `0x0000` if outside the screen
+    /// @note Read from previous frame-buffer when next frame-buffer not yet copied
     /// @n @b More: @ref Colour, @ref Coordinate
     ///
     uint16_t s_getPoint(uint16_t x1, uint16_t y1);
 
+    ///
+    /// @brief Check, clip and orient area
+    /// @param x1 top left coordinate, x-axis, modified
+    /// @param y1 top left coordinate, y-axis, modified
+    /// @param x2 bottom right coordinate, x-axis, modified
+    /// @param y2 bottom right coordinate, y-axis, modified
+    /// @return `RESULT_SUCCESS` = false = success, `RESULT_ERROR` = true = outside screen
+    /// @note Physical coordinates returned sorted
+    ///
+    bool s_orientArea(uint16_t & x1, uint16_t & y1, uint16_t & x2, uint16_t & y2);
+
+    ///
+    /// @brief Move bits within the frame-buffer
+    /// @param sourceBit first bit of the source, from the start of the frame-buffer
+    /// @param targetBit first bit of the target, from the start of the frame-buffer
+    /// @param length number of bits
+    /// @note Most significant bit first, source and target may overlap
+    /// @note With same bit position in bytes, memmove() for the middle bytes
+    ///
+    void s_moveBits(uint32_t sourceBit, uint32_t targetBit, uint32_t length);
+
+    ///
+    /// @brief Get 8 bits from the frame-buffer
+    /// @param bit first bit, from the start of the frame-buffer, may be negative
+    /// @return 8 bits, 0 for bits outside the frame-buffer
+    ///
+    uint8_t s_getBits8(int32_t bit);
+
+    ///
+    /// @brief Get position of a pixel in bits, physical coordinates
+    /// @param x1 x coordinate, physical
+    /// @param y1 y coordinate, physical
+    /// @return first bit of the pixel, from the start of the frame-buffer
+    ///
+    uint32_t s_getBit(uint16_t x1, uint16_t y1);
+
+    ///
+    /// @brief Operate on block, physical coordinates
+    /// @param x1 first point coordinate, x-axis
+    /// @param x2 last point coordinate, x-axis
+    /// @param y1 first point coordinate, y-axis
+    /// @param y2 last point coordinate, y-axis
+    /// @param operation `OPERATION_INVERT`, `OPERATION_SWAP` or `OPERATION_COMPARE`
+    /// @return true if a difference found with `OPERATION_COMPARE`
+    /// @note Byte by byte with masks, with pen set by s_setPen()
+    ///
+    bool s_operateBlock(uint16_t x1, uint16_t x2, uint16_t y1, uint16_t y2, uint8_t operation);
+
     ///
     /// @brief Update the screen
-    /// @param updateMode update mode, default = `UPDATE_NORMAL`, otherwise `UPDATE_FAST`
+    /// @param flagForce default = `false` = skip identical frames, `true` = always update
+    /// @return number of bytes changed, `0` when the update is skipped
+    /// @note Update mode set by the film, fast update for embedded fast update, normal update otherwise
+    /// @note Number of bytes sent per page for the first update and for screens without embedded fast update
+    ///
+    uint32_t s_flush(bool flagForce = false);
+
+    ///
+    /// @brief Render and output the screen band by band
+    /// @return number of bytes sent per page
+    ///
+    uint32_t s_flushBands();
+
+    ///
+    /// @brief Release the frame-buffer if generated by begin()
+    ///
+    void s_deleteFrameBuffer();
+
+    ///
+    /// @brief Send the pages from external memory to the output function
+    /// @return number of bytes sent per page
+    ///
+    uint32_t s_flushMemory();
+
+    ///
+    /// @brief Read a band of physical lines from external memory into the cache
+    /// @param first first physical line, multiple of the lines per band
+    /// @note Band in cache written back first if changed
+    ///
+    void s_loadBand(uint16_t first);
+
+    ///
+    /// @brief Write the band in cache back to external memory if changed
+    ///
+    void s_storeBand();
+
+    ///
+    /// @brief Transfer the band in cache with external memory
+    /// @param flagRead true = read from external memory, false = write to external memory
+    ///
+    void s_transferBand(bool flagRead);
+
+    ///
+    /// @brief Draw a command on each band it covers
+    /// @param item first word of the command
+    ///
+    void s_listCommand(const uint16_t * item);
+
+    ///
+    /// @brief Run an operation on area on each band it covers
+    /// @param x1 top left coordinate, x-axis
+    /// @param y1 top left coordinate, y-axis
+    /// @param x2 bottom right coordinate, x-axis
+    /// @param y2 bottom right coordinate, y-axis
+    /// @param operation `OPERATION_INVERT`, `OPERATION_SWAP` or `OPERATION_COMPARE`
+    /// @param colour 16-bit colour for highlight() and isClear()
+    /// @return result of isClear()
+    ///
+    bool s_operateMemory(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2, uint8_t operation, uint16_t colour);
+
+    ///
+    /// @brief Physical line of a point
+    /// @param x1 coordinate, x-axis
+    /// @param y1 coordinate, y-axis
+    /// @return physical line, on the screen
+    /// @note Coordinates not checked
+    ///
+    uint16_t s_getLine(uint16_t x1, uint16_t y1);
+
+    ///
+    /// @brief Select the band of physical lines for drawing
+    /// @param first first physical line, multiple of 8
+    /// @param lines number of physical lines
+    ///
+    void s_setBand(uint16_t first, uint16_t lines);
+
+    ///
+    /// @brief Reset the clip rectangle to the screen, or to the band
+    /// @note Screen with external memory, bands clipped by s_listCommand()
+    ///
+    void s_resetClip();
+
+    ///
+    /// @brief Limit the clip rectangle to the band
     ///
-    void s_flush(uint8_t updateMode = UPDATE_NORMAL);
+    void s_clipBand();
+
+    ///
+    /// @brief Swap next and previous frame-buffers after fast update
+    /// @note Copy of previous into next deferred to s_syncLines(), all groups of lines stale
+    ///
+    void s_swapNext();
+
+    ///
+    /// @brief Copy stale lines of previous frame-buffer into next
+    /// @param first first physical line
+    /// @param last last physical line
+    /// @param flagOverwrite true if the lines are fully written, no copy for the groups within
+    /// @note Called before drawing, by groups of u_staleLines lines
+    ///
+    void s_syncLines(uint16_t first, uint16_t last, bool flagOverwrite = false);
+
+    ///
+    /// @brief Check whether a line of next frame-buffer is not yet copied from previous
+    /// @param line physical line
+    /// @return true if stale, read previous frame-buffer instead
+    ///
+    bool s_isStale(uint16_t line);
+
+    ///
+    /// @brief Count bytes changed between two frame-buffers
+    /// @param next next frame-buffer
+    /// @param previous previous frame-buffer
+    /// @param size size of the frame-buffers
+    /// @return number of bytes changed
+    /// @note Compare by words of 4 bytes
+    ///
+    uint32_t s_countChanges(FRAMEBUFFER_TYPE next, FRAMEBUFFER_TYPE previous, uint32_t size);
 
     // Position
     ///
@@ -302,6 +791,113 @@ class Screen_EPD final : public hV_Screen_Buffer
     ///
     uint16_t s_getB(uint16_t x1, uint16_t y1);
 
+    // Pixel kernels
+    ///
+    /// @brief Pixel kernel
+    /// @details Write the physical code of one pixel into the frame-buffer
+    /// @param x1 x coordinate, physical
+    /// @param y1 y coordinate, physical
+    /// @param code physical code from s_setPen()
+    ///
+    typedef void (Screen_EPD::*pixelKernel_t)(uint16_t x1, uint16_t y1, uint8_t code);
+
+    ///
+    /// @brief Select the pixel kernel for the frame-buffer layout
+    /// @note Called once by begin()
+    /// @note Single page for monochrome mode
+    ///
+    void s_selectKernel();
+
+    ///
+    /// @brief Convert a 16-bit colour into physical codes
+    /// @param colour 16-bit colour
+    /// @note Result cached in u_penColour and u_penCode[]
+    ///
+    void s_setPen(uint16_t colour);
+
+    ///
+    /// @brief Get physical code of a pixel
+    /// @param colour 16-bit colour
+    /// @param x1 x coordinate, physical
+    /// @param y1 y coordinate, physical
+    /// @return physical code, PEN_NONE if not supported
+    /// @note Pen converted only when colour changes
+    ///
+    uint8_t s_getCode(uint16_t colour, uint16_t x1, uint16_t y1);
+
+    ///
+    /// @brief Set span between two points within screen, logical coordinates
+    /// @param x1 first point coordinate, x-axis
+    /// @param y1 first point coordinate, y-axis
+    /// @param x2 last point coordinate, x-axis
+    /// @param y2 last point coordinate, y-axis
+    /// @param colour 16-bit colour
+    /// @note Either x1 == x2 or y1 == y2
+    ///
+    void s_setSpan(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2, uint16_t colour);
+
+    ///
+    /// @brief Set block, physical coordinates
+    /// @param x1 first point coordinate, x-axis
+    /// @param x2 last point coordinate, x-axis
+    /// @param y1 first point coordinate, y-axis
+    /// @param y2 last point coordinate, y-axis
+    /// @note For each row, masked head byte, full middle bytes, masked tail byte, with pen set by s_setPen()
+    ///
+    void s_setBlock(uint16_t x1, uint16_t x2, uint16_t y1, uint16_t y2);
+
+    ///
+    /// @brief Set run across bytes, physical coordinates
+    /// @param x1 first point coordinate, x-axis
+    /// @param x2 last point coordinate, x-axis
+    /// @param y1 point coordinate, y-axis
+    /// @note Same mask on each byte, with pen set by s_setPen()
+    ///
+    void s_setRunStrided(uint16_t x1, uint16_t x2, uint16_t y1);
+
+    ///
+    /// @brief Set block with dithering, physical coordinates
+    /// @param x1 first point coordinate, x-axis
+    /// @param x2 last point coordinate, x-axis
+    /// @param y1 first point coordinate, y-axis
+    /// @param y2 last point coordinate, y-axis
+    /// @note Pixel by pixel, with pen set by s_setPen()
+    ///
+    void s_setBlockDither(uint16_t x1, uint16_t x2, uint16_t y1, uint16_t y2);
+
+    ///
+    /// @brief Build the look-up table for dithering
+    /// @note Palette based on the frame-buffer layout
+    ///
+    void s_setDitherTable();
+
+    ///
+    /// @brief Get dithering entry for a colour
+    /// @param colour 16-bit colour
+    /// @return entry, b7-b6 = first code, b5-b4 = second code, b3-b0 = level of second code in 1/16
+    ///
+    uint8_t s_getDitherEntry(uint16_t colour);
+
+    ///
+    /// @brief Get physical code from a dithering entry
+    /// @param entry entry from s_getDitherEntry()
+    /// @param x1 x coordinate, physical
+    /// @param y1 y coordinate, physical
+    /// @return physical code
+    ///
+    uint8_t s_getDitherCode(uint8_t entry, uint16_t x1, uint16_t y1);
+
+    ///
+    /// @name Pixel kernels, one per frame-buffer layout
+    /// @{
+    void s_kernelBW(uint16_t x1, uint16_t y1, uint8_t code); ///< BW, 1 bit per pixel, 1 page
+    void s_kernelBWR(uint16_t x1, uint16_t y1, uint8_t code); ///< BWR, 1 bit per pixel, 2 pages
+    void s_kernelBWRY(uint16_t x1, uint16_t y1, uint8_t code); ///< BWRY, 2 bits per pixel, 1 page
+    void s_kernelLargeBW(uint16_t x1, uint16_t y1, uint8_t code); ///< BW, large screen with two halves
+    void s_kernelLargeBWR(uint16_t x1, uint16_t y1, uint8_t code); ///< BWR, large screen with two halves
+    void s_kernelLargeBWRY(uint16_t x1, uint16_t y1, uint8_t code); ///< BWRY, large screen with two halves
+    /// @}
+
     //
     // === Energy section
     //
@@ -319,6 +915,51 @@ class Screen_EPD final : public hV_Screen_Buffer
     uint8_t u_codeExtra;
     uint16_t u_bufferSizeV, u_bufferSizeH, u_bufferDepth;
     uint32_t u_pageColourSize;
+    FRAMEBUFFER_TYPE u_newFrameBuffer; ///< frame-buffer, all pages
+    uint32_t u_frameBufferSize; ///< size of the frame-buffer, in bytes
+    bool u_frameBufferOwner; ///< true if generated by begin(), false if supplied by the caller
+    FRAMEBUFFER_TYPE u_previousImage; ///< previous frame-buffer for fast update, second colour page otherwise
+    bool u_flagPrevious; ///< previous frame-buffer displayed, fast update
+    uint8_t u_staleMask[STALE_GROUPS >> 3]; ///< one bit per group of lines to be copied from previous, fast update
+    uint8_t u_staleCount; ///< number of stale groups, 0 if none
+    uint8_t u_staleGroups; ///< number of groups for the screen
+    uint16_t u_staleLines; ///< physical lines per group
+
+    // Banded rendering
+    uint32_t u_bandSize; ///< requested size of the band frame-buffer, 0 if none
+    uint16_t u_bandLines; ///< physical lines per band, 0 if no band
+    uint16_t u_bandFirst; ///< first physical line of the current band
+    bandRender_t u_bandRender; ///< function drawing the screen
+    bandOutput_t u_bandOutput; ///< function receiving the bands
+
+    // External memory
+    Memory_Virtual * u_memory; ///< external memory for the frame-buffer, nullptr if none
+    bool u_memoryLoaded; ///< band in cache read from external memory
+    bool u_memoryDirty; ///< band in cache changed since read
+
+    // Frame-buffer layout
+    uint8_t u_layout; ///< LAYOUT_BW, LAYOUT_BWR or LAYOUT_BWRY
+    bool u_layoutLarge; ///< true for large screens with two halves
+    bool u_monochrome; ///< single page for normal-update screens, set by setMonochrome()
+    pixelKernel_t u_kernel; ///< pixel kernel selected by begin()
+    uint16_t u_penColour; ///< last colour converted by s_setPen()
+    uint8_t u_penCode[2]; ///< physical codes for even and odd pixels, PEN_NONE if not supported
+    uint8_t u_penPattern[2][2]; ///< byte patterns per page, for even and odd first pixel
+    uint8_t u_penEntry; ///< dithering entry, 0 if no dithering
+    uint8_t u_ditherSize; ///< size of Bayer matrix
+    uint8_t u_ditherTable[256]; ///< dithering entries, RGB 3-3-2 index
+
+    // Glyph cache
+    uint32_t * u_glyphCache; ///< glyphs, u_glyphRows rows per slot
+#if (GLYPH_CACHE_SLOTS > 0)
+    uint16_t u_glyphKey[GLYPH_CACHE_SLOTS]; ///< glyph per slot, 0xffff if empty
+#endif // GLYPH_CACHE_SLOTS
+    uint8_t u_glyphFont; ///< font of the cached glyphs, 0xff if none
+    uint8_t u_glyphOrientation; ///< orientation of the cached glyphs
+    uint8_t u_glyphRows; ///< rows per slot
+    bool u_glyphPen; ///< u_glyphCodes[] valid for u_glyphColours[]
+    uint16_t u_glyphColours[2]; ///< background and text colours
+    uint8_t u_glyphCodes[2]; ///< physical codes for background and text, PEN_NONE if not solid
 
     uint8_t u_suspendMode = POWER_MODE_AUTO;
     uint8_t u_suspendScope = POWER_SCOPE_GPIO_ONLY;
@@ -0,0 +1,354 @@
+//
+// hV_Console.cpp
+// Library C++ code
+// ----------------------------------
+//
+// Project Pervasive Displays Library Suite
+// Based on highView technology
+//
+// Created by Rei Vilo, 21 Jul 2026
+//
+// Copyright (c) Pervasive Displays Inc., 2021-2026
+// Copyright (c) Etigues, 2010-2026
+// Licence Creative Commons Attribution-ShareAlike 4.0 International (CC BY-SA 4.0)
+// For exclusive use with Pervasive Displays screens
+//
+// See hV_Console.h for references
+//
+// Release 1009: Added console with character cells
+//
+
+// Library header
+#include "hV_Console.h"
+
+// Allocation without exception
+#include <new>
+
+// Characters per call to gText()
+#define CONSOLE_RUN 32
+
+Console::Console(Screen_EPD * screen)
+{
+    _pScreen = screen;
+    _cells = 0; // nullptr
+    _shown = 0; // nullptr
+    _columns = 0;
+    _rows = 0;
+}
+
+bool Console::begin(uint8_t fontIndex, uint16_t x0, uint16_t y0, uint16_t dx, uint16_t dy)
+{
+    end();
+
+    if ((x0 >= _pScreen->screenSizeX()) or (y0 >= _pScreen->screenSizeY()))
+    {
+        return RESULT_ERROR;
+    }
+    if ((dx == 0) or (x0 + dx > _pScreen->screenSizeX()))
+    {
+        dx = _pScreen->screenSizeX() - x0;
+    }
+    if ((dy == 0) or (y0 + dy > _pScreen->screenSizeY()))
+    {
+        dy = _pScreen->screenSizeY() - y0;
+    }
+
+    // Cell size from font
+    uint8_t font = _pScreen->getFont();
+    _pScreen->selectFont(fontIndex);
+    _fontIndex = _pScreen->getFont();
+    _cellX = _pScreen->characterSizeX();
+    _cellY = _pScreen->characterSizeY();
+    _pScreen->selectFont(font);
+
+    if ((_cellX == 0) or (_cellY == 0))
+    {
+        return RESULT_ERROR;
+    }
+
+    _x0 = x0;
+    _y0 = y0;
+    _columns = hV_HAL_min(dx / _cellX, 0xff);
+    _rows = hV_HAL_min(dy / _cellY, 0xff);
+    if ((_columns == 0) or (_rows == 0))
+    {
+        return RESULT_ERROR;
+    }
+
+    _cells = new (std::nothrow) uint8_t[_columns * _rows];
+    _shown = new (std::nothrow) uint8_t[_columns * _rows];
+    if ((_cells == 0) or (_shown == 0))
+    {
+        end();
+        hV_HAL_log(LEVEL_ERROR, "Console grid not created");
+        return RESULT_ERROR;
+    }
+
+    _colourFront = myColours.black;
+    _colourBack = myColours.white;
+    _flagWrap = true;
+    _top = 0;
+    _bottom = _rows - 1;
+    clear();
+
+    return RESULT_SUCCESS;
+}
+
+void Console::end()
+{
+    delete[] _cells;
+    delete[] _shown;
+    _cells = 0; // nullptr
+    _shown = 0; // nullptr
+    _columns = 0;
+    _rows = 0;
+}
+
+void Console::setColours(uint16_t frontColour, uint16_t backColour)
+{
+    _colourFront = frontColour;
+    _colourBack = backColour;
+}
+
+void Console::setWrap(bool flag)
+{
+    _flagWrap = flag;
+}
+
+void Console::setScrollRegion(uint8_t top, uint8_t bottom)
+{
+    if (_rows == 0)
+    {
+        return;
+    }
+
+    _bottom = hV_HAL_min(bottom, (uint8_t)(_rows - 1));
+    _top = hV_HAL_min(top, _bottom);
+    _column = 0;
+    _row = _top;
+}
+
+void Console::setCursor(uint8_t column, uint8_t row)
+{
+    if ((column < _columns) and (row < _rows))
+    {
+        _column = column;
+        _row = row;
+    }
+}
+
+uint8_t Console::cursorColumn()
+{
+    return _column;
+}
+
+uint8_t Console::cursorRow()
+{
+    return _row;
+}
+
+uint8_t Console::columns()
+{
+    return _columns;
+}
+
+uint8_t Console::rows()
+{
+    return _rows;
+}
+
+void Console::clear()
+{
+    if (_rows == 0)
+    {
+        return;
+    }
+
+    // Frame-buffer cleared once, cells marked as shown
+    bool penSolid = _pScreen->getPenSolid();
+    _pScreen->setPenSolid(true);
+    _pScreen->dRectangle(_x0, _y0, _columns * _cellX, _rows * _cellY, _colourBack);
+    _pScreen->setPenSolid(penSolid);
+    memset(_cells, ' ', _columns * _rows);
+    memset(_shown, ' ', _columns * _rows);
+    _column = 0;
+    _row = 0;
+    _flagScrolled = true;
+}
+
+void Console::write(uint16_t character)
+{
+    if (_rows == 0)
+    {
+        return;
+    }
+
+    switch (character)
+    {
+        case '\n':
+
+            _newLine();
+            break;
+
+        case '\r':
+
+            _column = 0;
+            break;
+
+        case '\b':
+
+            if (_column > 0)
+            {
+                _column -= 1;
+            }
+            break;
+
+        case '\t':
+
+            _column = hV_HAL_min((_column + 8) & 0xf8, _columns);
+            break;
+
+        case '\f':
+
+            clear();
+            break;
+
+        default:
+
+            if (character < ' ')
+            {
+                break;
+            }
+
+            // Deferred wrap
+            if (_column >= _columns)
+            {
+                if (_flagWrap == false)
+                {
+                    break;
+                }
+                _newLine();
+            }
+
+            // Same convention as gText(), euro sign at 0x80
+            _cells[_row * _columns + _column] = (character == 0x20ac) ? 0x80 : (character & 0xff);
+            _column += 1;
+            break;
+    }
+}
+
+void Console::print(STRING_CONST_TYPE text)
+{
+    TextIterator iterator(text.c_str());
+    uint16_t character;
+
+    while ((character = iterator.next()) != 0x0000)
+    {
+        write(character);
+    }
+}
+
+uint16_t Console::render()
+{
+    if (_rows == 0)
+    {
+        return 0;
+    }
+
+    uint16_t count = 0;
+    uint16_t run[CONSOLE_RUN + 1];
+    uint8_t font = _pScreen->getFont();
+    bool fontSolid = _pScreen->getFontSolid();
+    _pScreen->selectFont(_fontIndex);
+    _pScreen->setFontSolid(true);
+
+    for (uint8_t row = 0; row < _rows; row++)
+    {
+        uint8_t * cells = _cells + row * _columns;
+        uint8_t * shown = _shown + row * _columns;
+        uint8_t column = 0;
+
+        while (column < _columns)
+        {
+            // Skip unchanged cells
+            if (cells[column] == shown[column])
+            {
+                column += 1;
+                continue;
+            }
+
+            // Run of changed cells, one gText() call
+            uint8_t start = column;
+            uint8_t length = 0;
+            while ((column < _columns) and (cells[column] != shown[column]) and (length < CONSOLE_RUN))
+            {
+                run[length] = (cells[column] == 0x80) ? 0x20ac : cells[column];
+                shown[column] = cells[column];
+                length += 1;
+                column += 1;
+            }
+            run[length] = 0x0000;
+
+            _pScreen->gText(_x0 + start * _cellX, _y0 + row * _cellY, run, _colourFront, _colourBack);
+            count += length;
+        }
+    }
+
+    _pScreen->selectFont(font);
+    _pScreen->setFontSolid(fontSolid);
+    return count;
+}
+
+void Console::flush(uint8_t updateMode)
+{
+    if ((render() == 0) and (_flagScrolled == false))
+    {
+        return;
+    }
+
+    _flagScrolled = false;
+    if (updateMode == UPDATE_FAST)
+    {
+        _pScreen->flushFast();
+    }
+    else
+    {
+        _pScreen->flush();
+    }
+}
+
+void Console::_newLine()
+{
+    _column = 0;
+    if (_row == _bottom)
+    {
+        _scrollUp();
+    }
+    else if (_row < _rows - 1)
+    {
+        _row += 1;
+    }
+}
+
+void Console::_scrollUp()
+{
+    // Frame-buffer rows moved, shown cells follow
+    bool result = _pScreen->scroll(_x0, _y0 + _top * _cellY,
+                                   _x0 + _columns * _cellX - 1, _y0 + (_bottom + 1) * _cellY - 1,
+                                   0, -(int16_t)_cellY, _colourBack);
+
+    uint16_t size = (_bottom - _top) * _columns;
+    memmove(_cells + _top * _columns, _cells + (_top + 1) * _columns, size);
+    memset(_cells + _bottom * _columns, ' ', _columns);
+    if (result == RESULT_SUCCESS)
+    {
+        memmove(_shown + _top * _columns, _shown + (_top + 1) * _columns, size);
+        memset(_shown + _bottom * _columns, ' ', _columns);
+    }
+    else
+    {
+        // Rows not moved, all cells drawn again
+        memset(_shown, 0x00, _columns * _rows);
+    }
+    _flagScrolled = true;
+}
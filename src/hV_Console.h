@@ -0,0 +1,202 @@
+///
+/// @file hV_Console.h
+/// @brief Text console with character cells - Basic edition
+///
+/// @details Project Pervasive Displays Library Suite
+/// @n Based on highView technology
+///
+/// @date 21 Jul 2026
+/// @version 1009
+///
+/// @copyright (c) Pervasive Displays Inc., 2021-2026
+/// @copyright (c) Etigues, 2010-2026
+/// @copyright All rights reserved
+/// @copyright For exclusive use with Pervasive Displays screens
+///
+/// * Basic edition: for hobbyists and for basic usage
+/// @n Creative Commons Attribution-ShareAlike 4.0 International (CC BY-SA 4.0)
+/// @see https://creativecommons.org/licenses/by-sa/4.0/
+///
+/// @n Consider the Evaluation or Commercial editions for professionals or organisations and for commercial usage
+///
+/// * Evaluation edition: for professionals or organisations, evaluation only, no commercial usage
+/// @n All rights reserved
+///
+/// * Commercial edition: for professionals or organisations, commercial usage
+/// @n All rights reserved
+///
+/// * Viewer edition: for professionals or organisations
+/// @n All rights reserved
+///
+/// * Documentation
+/// @n All rights reserved
+///
+
+#ifndef hV_CONSOLE_RELEASE
+///
+/// @brief Library release number
+///
+#define hV_CONSOLE_RELEASE 1009
+
+// SDK and configuration
+#include "PDLS_Common.h"
+
+#if (PDLS_COMMON_RELEASE < 1000)
+#error Required PDLS_COMMON_RELEASE 1000
+#endif // PDLS_COMMON_RELEASE
+
+// Other libraries
+#include "Screen_EPD.h"
+
+#if (SCREEN_EPD_RELEASE < 1009)
+#error Required SCREEN_EPD_RELEASE 1009
+#endif // SCREEN_EPD_RELEASE
+
+///
+/// @class Console
+/// @brief Text console
+/// @details Grid of character cells with cursor, automatic wrap and scroll region
+/// @note Only the cells with a changed character are rendered
+/// @note Scroll moves the rows of the frame-buffer with Screen_EPD::scroll()
+/// @note Without scroll, for example with bands, all the cells are rendered again
+///
+class Console
+{
+  public:
+    ///
+    /// @brief Constructor
+    /// @param screen &screen to display the console on
+    ///
+    Console(Screen_EPD * screen);
+
+    ///
+    /// @brief Initialise the console
+    /// @param fontIndex terminal font, default = 0, 0..fontMax()-1
+    /// @param x0 top left coordinate, x-axis, default = 0
+    /// @param y0 top left coordinate, y-axis, default = 0
+    /// @param dx width, default = 0 = up to the right edge of the screen
+    /// @param dy height, default = 0 = up to the bottom edge of the screen
+    /// @return `RESULT_SUCCESS` = false = success, `RESULT_ERROR` = true = error
+    /// @note Grid of dx / characterSizeX() columns and dy / characterSizeY() rows
+    /// @note Area cleared with background colour
+    ///
+    bool begin(uint8_t fontIndex = 0, uint16_t x0 = 0, uint16_t y0 = 0, uint16_t dx = 0, uint16_t dy = 0);
+
+    ///
+    /// @brief Release the grid
+    ///
+    void end();
+
+    ///
+    /// @brief Set the colours
+    /// @param frontColour 16-bit colour for text, default = black
+    /// @param backColour 16-bit colour for background, default = white
+    /// @note Cells already rendered keep their colours
+    ///
+    void setColours(uint16_t frontColour = myColours.black, uint16_t backColour = myColours.white);
+
+    ///
+    /// @brief Set automatic wrap
+    /// @param flag default = true = new line at the end of a row, false = characters beyond the end of a row ignored
+    ///
+    void setWrap(bool flag = true);
+
+    ///
+    /// @brief Set the scroll region
+    /// @param top first row, default = 0
+    /// @param bottom last row, default = 0xff = last row of the grid
+    /// @note Cursor moved to the first column of the top row
+    ///
+    void setScrollRegion(uint8_t top = 0, uint8_t bottom = 0xff);
+
+    ///
+    /// @brief Set cursor
+    /// @param column column, 0..columns()-1
+    /// @param row row, 0..rows()-1
+    ///
+    void setCursor(uint8_t column, uint8_t row);
+
+    ///
+    /// @brief Get cursor column
+    /// @return column
+    ///
+    uint8_t cursorColumn();
+
+    ///
+    /// @brief Get cursor row
+    /// @return row
+    ///
+    uint8_t cursorRow();
+
+    ///
+    /// @brief Number of columns
+    /// @return columns
+    ///
+    uint8_t columns();
+
+    ///
+    /// @brief Number of rows
+    /// @return rows
+    ///
+    uint8_t rows();
+
+    ///
+    /// @brief Write one character
+    /// @param character 16-bit character
+    /// @note Control characters: `\n` new line, `\r` carriage return, `\b` backspace, `\t` tabulation, `\f` clear
+    ///
+    void write(uint16_t character);
+
+    ///
+    /// @brief Print text
+    /// @param text UTF-8 coded text
+    ///
+    void print(STRING_CONST_TYPE text);
+
+    ///
+    /// @brief Clear the grid
+    /// @note Cursor moved to top left
+    ///
+    void clear();
+
+    ///
+    /// @brief Render the changed cells into the frame-buffer
+    /// @return number of cells rendered
+    /// @note Font selected and solid font set on the screen
+    ///
+    uint16_t render();
+
+    ///
+    /// @brief Render the changed cells and update the screen
+    /// @param updateMode default = `UPDATE_FAST`, otherwise `UPDATE_NORMAL`
+    /// @note Screen not updated if no cell changed and no scroll
+    ///
+    void flush(uint8_t updateMode = UPDATE_FAST);
+
+  protected:
+    /// @cond
+    ///
+    /// @brief Move to new line, scroll if required
+    ///
+    void _newLine();
+
+    ///
+    /// @brief Scroll the scroll region one row up
+    ///
+    void _scrollUp();
+
+    Screen_EPD * _pScreen;
+    uint8_t _fontIndex;
+    uint16_t _x0, _y0, _cellX, _cellY;
+    uint8_t _columns, _rows;
+    uint8_t _column, _row;
+    uint8_t _top, _bottom;
+    bool _flagWrap;
+    bool _flagScrolled; ///< frame-buffer scrolled since last flush
+    uint16_t _colourFront, _colourBack;
+    uint8_t * _cells; ///< characters to display
+    uint8_t * _shown; ///< characters in the frame-buffer
+    /// @endcond
+};
+
+#endif // hV_CONSOLE_RELEASE
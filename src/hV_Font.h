@@ -68,6 +68,30 @@ struct width_s
     uint32_t index; ///< relative address
 };
 
+///
+/// @name Compression of glyphs
+/// @{
+#define GLYPH_RAW 0x00 ///< Columns stored as is
+#define GLYPH_RLE 0x01 ///< Columns compressed with run-length encoding
+/// @}
+
+///
+/// @brief Structure for glyph of compact font
+/// @details Glyphs sorted by character for binary search
+/// @note
+/// * Columns from left to right, (height + 7) / 8 bytes per column
+/// * Bit j of byte b for row 8 * b + j, from top to bottom
+/// * GLYPH_RLE: control byte 0x00..0x7f followed by 1..128 bytes copied,
+/// control byte 0x80..0xff followed by 1 byte repeated 1..128 times
+///
+struct glyph_s
+{
+    uint16_t character; ///< UTF-16 character
+    uint8_t width; ///< width in pixels
+    uint8_t compression; ///< GLYPH_RAW or GLYPH_RLE
+    uint32_t index; ///< relative address of first byte in *table array
+};
+
 ///
 /// @brief Structure for font
 /// @details Fonts read from header file in internal MCU Flash
@@ -78,6 +102,7 @@ struct width_s
 /// * maxWidth: to be calculated
 /// * Bytes per character: see *width array
 /// * Character definition: see *table array
+/// * Compact font: *glyph array sorted by character, *table array with columns
 ///
 /// @n Font kind
 /// * 0x4-..0x1- 0b7654
@@ -100,6 +125,9 @@ struct font_s
     uint8_t maxWidth; ///< maximum width in pixels from *width array
     uint8_t first; ///< number of first character, usually 32
     uint8_t number; ///< number of characters, usually 96 or 224
+    const glyph_s * glyph; ///< compact font, glyphs sorted by character, nullptr for terminal fonts
+    uint16_t glyphNumber; ///< compact font, number of glyphs
+    const uint8_t * table; ///< compact font, columns of the glyphs
 };
 
 #endif // USE_FONT_TERMINAL
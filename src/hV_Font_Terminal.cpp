@@ -22,6 +22,8 @@
 //
 // Release 803: Added types for string and frame-buffer
 // Release 1000: Added support for UTF-8 strings
+// Release 1009: Added iterator on text
+// Release 1009: Added compact fonts with addFont()
 //
 
 // The Arduino IDE does not allow to select the libraries, hence this condition.
@@ -31,6 +33,87 @@
 #include "hV_Font_Terminal.h"
 
 // Code
+// Text iterator
+TextIterator::TextIterator(const char * text8)
+{
+    _text8 = (const uint8_t *)text8;
+    _text16 = 0; // nullptr
+}
+
+TextIterator::TextIterator(STRING16_CONST_TYPE text16)
+{
+    _text8 = 0; // nullptr
+    _text16 = text16;
+}
+
+uint16_t TextIterator::next()
+{
+    uint16_t character = 0x0000;
+
+    // UTF-16
+    if (_text16 != 0)
+    {
+        character = *_text16;
+        if (character != 0x0000)
+        {
+            _text16 += 1;
+        }
+        return character;
+    }
+
+    if (_text8 == 0)
+    {
+        return 0x0000;
+    }
+
+    // ASCII
+    uint8_t byte = *_text8;
+    if (byte < 0x80)
+    {
+        if (byte != 0x00)
+        {
+            _text8 += 1;
+        }
+        return byte;
+    }
+
+    // Sequences of 2 or 3 bytes
+    uint8_t length = 0;
+    if ((byte & 0xe0) == 0xc0)
+    {
+        character = byte & 0x1f;
+        length = 1;
+    }
+    else if ((byte & 0xf0) == 0xe0)
+    {
+        character = byte & 0x0f;
+        length = 2;
+    }
+    _text8 += 1;
+
+    for (uint8_t k = 0; k < length; k++)
+    {
+        if ((*_text8 & 0xc0) != 0x80)
+        {
+            return 0xfffd; // truncated sequence
+        }
+        character = (character << 6) | (*_text8 & 0x3f);
+        _text8 += 1;
+    }
+
+    if (length == 0)
+    {
+        // Sequence of 4 bytes or invalid first byte
+        while ((*_text8 & 0xc0) == 0x80)
+        {
+            _text8 += 1;
+        }
+        character = 0xfffd;
+    }
+
+    return character;
+}
+
 // Font functions
 // hV_Font_Terminal::hV_Font_Terminal()
 void hV_Font_Terminal::f_begin()
@@ -40,6 +123,7 @@ void hV_Font_Terminal::f_begin()
     f_fontSolid = true;
     f_fontSpaceX = 0;
     f_fontSpaceY = 0;
+    f_glyphDecoded = 0xffff;
 
     // Take first font
     f_selectFont(0);
@@ -47,6 +131,26 @@ void hV_Font_Terminal::f_begin()
 
 uint8_t hV_Font_Terminal::f_addFont(font_s fontName)
 {
+    // Compact font only, glyph up to 32 pixels high and within buffer
+    uint8_t bytes = (fontName.height + 7) >> 3;
+    if ((fontName.glyph == 0) or (fontName.table == 0) or (fontName.glyphNumber == 0))
+    {
+        hV_HAL_log(LEVEL_ERROR, "Font not compact");
+        return 0;
+    }
+    if ((fontName.height == 0) or (fontName.height > 32) or (fontName.maxWidth * bytes > FONT_GLYPH_BUFFER))
+    {
+        hV_HAL_log(LEVEL_ERROR, "Font too large");
+        return 0;
+    }
+    if (f_fontNumber >= MAX_FONT_SIZE + MAX_FONT_ADDED)
+    {
+        hV_HAL_log(LEVEL_ERROR, "No more font");
+        return 0;
+    }
+
+    f_fontAdded[f_fontNumber - MAX_FONT_SIZE] = fontName;
+    f_fontNumber += 1;
     return f_fontNumber;
 }
 
@@ -57,32 +161,40 @@ void hV_Font_Terminal::f_setFontSolid(bool flag)
 
 void hV_Font_Terminal::f_selectFont(uint8_t size)
 {
-    if (size < MAX_FONT_SIZE)
+    if (size < f_fontNumber)
     {
         f_fontIndex = size;
     }
     else
     {
-        f_fontIndex = MAX_FONT_SIZE - 1;
+        f_fontIndex = f_fontNumber - 1;
+    }
+    f_glyphDecoded = 0xffff;
+
+    // Compact fonts after terminal fonts
+    if (f_fontIndex >= MAX_FONT_SIZE)
+    {
+        f_font = f_fontAdded[f_fontIndex - MAX_FONT_SIZE];
+        return;
     }
 
     switch (f_fontIndex)
     {
         case 0:
             // kind, height, maxWidth, first, number
-            f_font = { 0x40, 8, 6, 32, 224 };
+            f_font = { 0x40, 8, 6, 32, 224, nullptr, 0, nullptr };
             break;
 
         case 1:
-            f_font = { 0x40, 12, 8, 32, 224 };
+            f_font = { 0x40, 12, 8, 32, 224, nullptr, 0, nullptr };
             break;
 
         case 2:
-            f_font = { 0x40, 16, 12, 32, 224 };
+            f_font = { 0x40, 16, 12, 32, 224, nullptr, 0, nullptr };
             break;
 
         case 3:
-            f_font = { 0x40, 24, 16, 32, 224 };
+            f_font = { 0x40, 24, 16, 32, 224, nullptr, 0, nullptr };
             break;
 
         default:
@@ -92,7 +204,7 @@ void hV_Font_Terminal::f_selectFont(uint8_t size)
 
 uint8_t hV_Font_Terminal::f_fontMax()
 {
-    return MAX_FONT_SIZE;
+    return f_fontNumber;
 }
 
 void hV_Font_Terminal::f_setFontSpaceX(uint8_t number)
@@ -105,27 +217,111 @@ void hV_Font_Terminal::f_setFontSpaceY(uint8_t number)
     f_fontSpaceY = number;
 }
 
-uint8_t hV_Font_Terminal::f_getCharacter(uint8_t character, uint16_t index)
+uint16_t hV_Font_Terminal::f_getGlyph(uint16_t character)
 {
+    // Terminal font, euro sign at 0x80
+    if (f_font.glyph == 0)
+    {
+        if (character == 0x20ac)
+        {
+            return 0x80 - ' ';
+        }
+        if ((character < ' ') or (character > 0xff))
+        {
+            character = '?';
+        }
+        return character - ' ';
+    }
+
+    // Compact font, binary search on sorted glyphs
+    uint16_t low = 0;
+    uint16_t high = f_font.glyphNumber;
+    while (low < high)
+    {
+        uint16_t middle = (low + high) >> 1;
+        uint16_t found = f_font.glyph[middle].character;
+        if (found == character)
+        {
+            return middle;
+        }
+        if (found < character)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+
+    // Character not in the font, question mark or first glyph
+    return (character == '?') ? 0 : f_getGlyph('?');
+}
+
+uint8_t hV_Font_Terminal::f_getWidth(uint16_t glyph)
+{
+    if (f_font.glyph == 0)
+    {
+        return f_font.maxWidth;
+    }
+    return f_font.glyph[glyph].width;
+}
+
+uint8_t hV_Font_Terminal::f_getCharacter(uint16_t glyph, uint16_t index)
+{
+    // Compact font
+    if (f_font.glyph != 0)
+    {
+        const glyph_s * item = &f_font.glyph[glyph];
+        const uint8_t * data = f_font.table + item->index;
+
+        if (item->compression == GLYPH_RAW)
+        {
+            return data[index];
+        }
+
+        // Run-length encoded, whole glyph decoded once
+        if (f_glyphDecoded != glyph)
+        {
+            uint16_t size = item->width * ((f_font.height + 7) >> 3);
+            uint16_t k = 0;
+            while (k < size)
+            {
+                uint8_t control = *data++;
+                uint8_t count = (control & 0x7f) + 1;
+                for (uint8_t c = 0; (c < count) and (k < size); c++)
+                {
+                    f_glyphBuffer[k++] = (control & 0x80) ? *data : *data++;
+                }
+                if (control & 0x80)
+                {
+                    data += 1;
+                }
+            }
+            f_glyphDecoded = glyph;
+        }
+        return f_glyphBuffer[index];
+    }
+
 #if (MAX_FONT_SIZE > 0)
     if (f_fontIndex == 0)
     {
-        return Terminal6x8e[character][index];
+        return Terminal6x8e[glyph][index];
     }
 #if (MAX_FONT_SIZE > 1)
     else if (f_fontIndex == 1)
     {
-        return Terminal8x12e[character][index];
+        return Terminal8x12e[glyph][index];
     }
 #if (MAX_FONT_SIZE > 2)
     else if (f_fontIndex == 2)
     {
-        return Terminal12x16e[character][index];
+        return Terminal12x16e[glyph][index];
     }
 #if (MAX_FONT_SIZE > 3)
     else if (f_fontIndex == 3)
     {
-        return Terminal16x24e[character][index];
+        return Terminal16x24e[glyph][index];
     }
 #endif // end MAX_FONT_SIZE > 3
 #endif // end MAX_FONT_SIZE > 2
@@ -139,6 +335,11 @@ uint8_t hV_Font_Terminal::f_getCharacter(uint8_t character, uint16_t index)
 
 uint16_t hV_Font_Terminal::f_characterSizeX(uint16_t character)
 {
+    // Compact font, width of the glyph
+    if ((f_font.glyph != 0) and (character != 0x0000))
+    {
+        return f_getWidth(f_getGlyph(character)) + f_fontSpaceX;
+    }
     return f_font.maxWidth;
 }
 
@@ -149,17 +350,42 @@ uint16_t hV_Font_Terminal::f_characterSizeY()
 
 uint16_t hV_Font_Terminal::f_stringSizeX(STRING_CONST_TYPE text8)
 {
-    uint16_t _buffer16[BUFFER_LENGTH] = {0};
+    TextIterator iterator(text8.c_str());
     uint16_t _size16 = 0;
+    uint16_t character;
 
-    _size16 = utf8to16(text8.c_str(), _buffer16);
+    // Compact font, sum of widths
+    if (f_font.glyph != 0)
+    {
+        while ((character = iterator.next()) != 0x0000)
+        {
+            _size16 += f_getWidth(f_getGlyph(character)) + f_fontSpaceX;
+        }
+        return _size16;
+    }
+
+    while (iterator.next() != 0x0000)
+    {
+        _size16 += 1;
+    }
 
-    return f_stringSizeX(_buffer16);
+    return (f_font.maxWidth + f_fontSpaceX) * _size16;
 }
 
 uint16_t hV_Font_Terminal::f_stringSizeX(STRING16_CONST_TYPE text16)
 {
     uint16_t _size16 = 0;
+
+    // Compact font, sum of widths
+    if (f_font.glyph != 0)
+    {
+        for (uint16_t k = 0; text16[k] != 0x0000; k++)
+        {
+            _size16 += f_getWidth(f_getGlyph(text16[k])) + f_fontSpaceX;
+        }
+        return _size16;
+    }
+
     while (text16[++_size16] != 0x0000);
     _size16 = (text16[0] == 0x0000) ? 0 : _size16;
 
@@ -168,19 +394,58 @@ uint16_t hV_Font_Terminal::f_stringSizeX(STRING16_CONST_TYPE text16)
 
 uint8_t hV_Font_Terminal::f_stringLengthToFitX(STRING_CONST_TYPE text8, uint16_t pixels)
 {
-    // uint8_t index = 0;
-    // uint16_t textWidth = 0;
+    // Monospaced font, count stops at limit
+    uint8_t index = pixels / f_font.maxWidth - 1;
     uint8_t _size16 = 0;
 
-    uint16_t _buffer16[BUFFER_LENGTH] = {0};
+    TextIterator iterator(text8.c_str());
+
+    // Compact font, widths summed up to limit
+    if (f_font.glyph != 0)
+    {
+        uint16_t character;
+        uint16_t width = 0;
+        while ((_size16 < 0xff) and ((character = iterator.next()) != 0x0000))
+        {
+            width += f_getWidth(f_getGlyph(character));
+            if (width > pixels)
+            {
+                break;
+            }
+            width += f_fontSpaceX;
+            _size16 += 1;
+        }
+        return _size16;
+    }
 
-    _size16 = utf8to16(text8.c_str(), _buffer16);
+    while ((_size16 < index) and (iterator.next() != 0x0000))
+    {
+        _size16 += 1;
+    }
 
-    return f_stringLengthToFitX(_buffer16, pixels);
+    return _size16;
 }
 
 uint8_t hV_Font_Terminal::f_stringLengthToFitX(STRING16_CONST_TYPE text16, uint16_t pixels)
 {
+    // Compact font, widths summed up to limit
+    if (f_font.glyph != 0)
+    {
+        uint8_t _size16 = 0;
+        uint16_t width = 0;
+        while ((_size16 < 0xff) and (text16[_size16] != 0x0000))
+        {
+            width += f_getWidth(f_getGlyph(text16[_size16]));
+            if (width > pixels)
+            {
+                break;
+            }
+            width += f_fontSpaceX;
+            _size16 += 1;
+        }
+        return _size16;
+    }
+
     uint8_t index = 0;
     // uint16_t textWidth = 0;
 
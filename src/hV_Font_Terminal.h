@@ -72,6 +72,21 @@
 #endif
 #endif
 
+///
+/// @brief Number of compact fonts added with addFont()
+///
+#ifndef MAX_FONT_ADDED
+#define MAX_FONT_ADDED 4
+#endif // MAX_FONT_ADDED
+
+///
+/// @brief Buffer for one decompressed glyph, in bytes
+/// @note Up to 32 columns of 32 rows
+///
+#ifndef FONT_GLYPH_BUFFER
+#define FONT_GLYPH_BUFFER 128
+#endif // FONT_GLYPH_BUFFER
+
 ///
 /// @brief Font enumeration
 /// @note Generated by hV_FontsFlash_Manage2
@@ -84,6 +99,39 @@ enum fontNumber_e
     Font_Terminal16x24,
 };
 
+///
+/// @brief Iterator on text
+/// @details Characters decoded one by one from UTF-8 or UTF-16 coded text, no buffer and no length limit
+/// @note UTF-8 sequences of 1 to 3 bytes, other sequences replaced by 0xfffd
+///
+class TextIterator
+{
+  public:
+    ///
+    /// @brief Constructor for UTF-8 coded text
+    /// @param text8 UTF-8 coded text, null-terminated
+    ///
+    TextIterator(const char * text8);
+
+    ///
+    /// @brief Constructor for UTF-16 coded text
+    /// @param text16 UTF-16 coded text, null-terminated
+    ///
+    TextIterator(STRING16_CONST_TYPE text16);
+
+    ///
+    /// @brief Next character
+    /// @return UTF-16 character, 0x0000 at end of text
+    ///
+    uint16_t next();
+
+  protected:
+    /// @cond
+    const uint8_t * _text8;
+    STRING16_CONST_TYPE _text16;
+    /// @endcond
+};
+
 ///
 /// @brief Class for font as header file
 ///
@@ -113,9 +161,11 @@ class hV_Font_Terminal
     ///
     /// @brief Use a font
     /// @param fontName name of the font
-    /// @return number of the font, 0 otherwise
+    /// @return number of fonts, 0 otherwise
+    /// @note The index of the font added is `number - 1`, as with the other editions
     /// @warning Definition for this method is compulsory.
     /// @note Previously setFontSize()
+    /// @note Only compact fonts with *glyph and *table arrays, up to 32 pixels high
     /// @n @b More: @ref Fonts
     ///
     uint8_t f_addFont(font_s fontName);
@@ -218,13 +268,31 @@ class hV_Font_Terminal
     ///
     uint8_t f_getFontMaxWidth();
 
+    ///
+    /// @brief Get glyph of character
+    /// @param character UTF-16 character
+    /// @return index of the glyph in the font
+    /// @note Terminal font, character - 32 with euro sign at 0x80
+    /// @note Compact font, binary search on the sorted glyphs
+    /// @note Character not in the font replaced by question mark
+    ///
+    uint16_t f_getGlyph(uint16_t character);
+
+    ///
+    /// @brief Get width of glyph
+    /// @param glyph index of the glyph in the font
+    /// @return width in pixels, without space
+    ///
+    uint8_t f_getWidth(uint16_t glyph);
+
     ///
     /// @brief Get definition for line of character
-    /// @param character character 32~255
-    /// @param index column index
+    /// @param glyph index of the glyph in the font
+    /// @param index byte index, (height + 7) / 8 bytes per column
     /// @return definition for line of character
+    /// @note Compressed glyph decoded once into the buffer
     ///
-    uint8_t f_getCharacter(uint8_t character, uint16_t index);
+    uint8_t f_getCharacter(uint16_t glyph, uint16_t index);
 
     ///
     /// @name Variables for font management
@@ -236,6 +304,9 @@ class hV_Font_Terminal
     uint8_t f_fontSpaceX; ///< pixels between two characters, horizontal axis
     uint8_t f_fontSpaceY; ///< pixels between two characters, vertical axis
     bool f_fontSolid; ///< opaque print
+    font_s f_fontAdded[MAX_FONT_ADDED]; ///< compact fonts, numbered from MAX_FONT_SIZE
+    uint16_t f_glyphDecoded; ///< glyph in f_glyphBuffer[], 0xffff if none
+    uint8_t f_glyphBuffer[FONT_GLYPH_BUFFER]; ///< decompressed glyph
     /// @}
 };
 /// @endcond
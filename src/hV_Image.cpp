@@ -0,0 +1,445 @@
+//
+// hV_Image.cpp
+// Library C++ code
+// ----------------------------------
+//
+// Project Pervasive Displays Library Suite
+// Based on highView technology
+//
+// Created by Rei Vilo, 21 Jul 2026
+//
+// Copyright (c) Pervasive Displays Inc., 2021-2026
+// Copyright (c) Etigues, 2010-2026
+// Licence Creative Commons Attribution-ShareAlike 4.0 International (CC BY-SA 4.0)
+// For exclusive use with Pervasive Displays screens
+//
+// See hV_Image.h for references
+//
+// Release 1009: Added streaming decoder for PBM, PGM and BMP
+//
+
+// Library header
+#include "hV_Image.h"
+
+// Pixels per chunk, multiple of 8
+#define IMAGE_CHUNK 64
+
+Image::Image(Screen_EPD * screen)
+{
+    _pScreen = screen;
+    _report = { IMAGE_NONE, 0, 0, 0, 0, 0 };
+}
+
+uint16_t Image::readMemory(uint8_t * buffer, uint16_t length, void * context)
+{
+    imageMemory_s * memory = (imageMemory_s *)context;
+    uint32_t number = hV_HAL_min(length, memory->size - memory->position);
+
+    memcpy(buffer, memory->data + memory->position, number);
+    memory->position += number;
+    return number;
+}
+
+bool Image::decode(readBytes_t readBytes, void * context, uint16_t x0, uint16_t y0)
+{
+    _readBytes = readBytes;
+    _context = context;
+    _bufferCount = 0;
+    _bufferIndex = 0;
+    _report = { IMAGE_NONE, 0, 0, 0, 0, 0 };
+
+    uint32_t chrono = hV_HAL_getMilliseconds();
+    bool result = RESULT_ERROR;
+    uint8_t signature[2];
+
+    if ((_getByte(signature[0]) == RESULT_SUCCESS) and (_getByte(signature[1]) == RESULT_SUCCESS))
+    {
+        if ((signature[0] == 'P') and (signature[1] == '4'))
+        {
+            result = _decodePNM(IMAGE_PBM, x0, y0);
+        }
+        else if ((signature[0] == 'P') and (signature[1] == '5'))
+        {
+            // Grey levels dithered by the screen, 4x4 if no dithering set
+            uint8_t dither = _pScreen->getDither();
+            if (dither == DITHER_NONE)
+            {
+                _pScreen->setDither(DITHER_4X4);
+            }
+            result = _decodePNM(IMAGE_PGM, x0, y0);
+            if (dither == DITHER_NONE)
+            {
+                _pScreen->setDither(dither);
+            }
+        }
+        else if ((signature[0] == 'B') and (signature[1] == 'M'))
+        {
+            result = _decodeBMP(x0, y0);
+        }
+    }
+
+    _report.milliseconds = hV_HAL_getMilliseconds() - chrono;
+    _report.bytesPerSecond = (_report.milliseconds > 0) ? (uint32_t)((uint64_t)_report.bytes * 1000 / _report.milliseconds) : 0;
+
+    if (result == RESULT_SUCCESS)
+    {
+        hV_HAL_log(LEVEL_INFO, "Image %ix%i, %i bytes in %i ms, %i bytes/s", _report.width, _report.height, _report.bytes, _report.milliseconds, _report.bytesPerSecond);
+    }
+    else
+    {
+        _report.format = IMAGE_NONE;
+        hV_HAL_log(LEVEL_ERROR, "Image not supported or truncated");
+    }
+
+    return result;
+}
+
+imageReport_s Image::getReport()
+{
+    return _report;
+}
+
+bool Image::_decodePNM(uint8_t format, uint16_t x0, uint16_t y0)
+{
+    uint32_t width, height;
+    uint32_t maxValue = 1;
+
+    if ((_getNumberASCII(width) == RESULT_ERROR) or (_getNumberASCII(height) == RESULT_ERROR))
+    {
+        return RESULT_ERROR;
+    }
+    if ((width == 0) or (height == 0) or (width > 0xffff) or (height > 0xffff))
+    {
+        return RESULT_ERROR;
+    }
+    if (format == IMAGE_PGM)
+    {
+        if ((_getNumberASCII(maxValue) == RESULT_ERROR) or (maxValue == 0) or (maxValue > 255))
+        {
+            return RESULT_ERROR;
+        }
+    }
+    // Single white space after header consumed by _getNumberASCII()
+
+    _report.format = format;
+    _report.width = width;
+    _report.height = height;
+
+    uint8_t chunk[IMAGE_CHUNK / 8]; // 1 bit per pixel, black = 1
+    uint16_t greys[IMAGE_CHUNK]; // 16-bit colours
+    uint8_t value;
+
+    for (uint32_t j = 0; j < height; j++)
+    {
+        for (uint32_t i = 0; i < width; i += IMAGE_CHUNK)
+        {
+            uint16_t number = hV_HAL_min(width - i, (uint32_t)IMAGE_CHUNK);
+
+            if (format == IMAGE_PBM)
+            {
+                for (uint8_t k = 0; k < ((number + 7) >> 3); k++)
+                {
+                    if (_getByte(chunk[k]) == RESULT_ERROR)
+                    {
+                        return RESULT_ERROR;
+                    }
+                }
+
+                if (x0 + i < 0x10000)
+                {
+                    _pScreen->drawBitmap(x0 + i, y0 + j, chunk, number, 1, myColours.black, myColours.white);
+                }
+            }
+            else // IMAGE_PGM
+            {
+                for (uint16_t k = 0; k < number; k++)
+                {
+                    if (_getByte(value) == RESULT_ERROR)
+                    {
+                        return RESULT_ERROR;
+                    }
+
+                    // Grey level into 16-bit colour, dithered by drawBitmap()
+                    uint8_t grey = (maxValue == 255) ? value : value * 255 / maxValue;
+                    greys[k] = ((grey >> 3) << 11) | ((grey >> 2) << 5) | (grey >> 3);
+                }
+
+                if (x0 + i < 0x10000)
+                {
+                    _pScreen->drawBitmap(x0 + i, y0 + j, greys, number, 1);
+                }
+            }
+        }
+    }
+
+    return RESULT_SUCCESS;
+}
+
+bool Image::_decodeBMP(uint16_t x0, uint16_t y0)
+{
+    // File header, 14 bytes, and information header, at least 40 bytes
+    uint32_t offset, headerSize, width, height, planes, bitsPerPixel, compression, colours;
+
+    if ((_skip(8) == RESULT_ERROR) or (_getNumberLE(4, offset) == RESULT_ERROR)
+            or (_getNumberLE(4, headerSize) == RESULT_ERROR) or (headerSize < 40)
+            or (_getNumberLE(4, width) == RESULT_ERROR) or (_getNumberLE(4, height) == RESULT_ERROR)
+            or (_getNumberLE(2, planes) == RESULT_ERROR) or (_getNumberLE(2, bitsPerPixel) == RESULT_ERROR)
+            or (_getNumberLE(4, compression) == RESULT_ERROR)
+            or (_skip(12) == RESULT_ERROR)
+            or (_getNumberLE(4, colours) == RESULT_ERROR)
+            or (_skip(headerSize - 36) == RESULT_ERROR))
+    {
+        return RESULT_ERROR;
+    }
+
+    // Negative height for top-down rows
+    bool flagTopDown = ((int32_t)height < 0);
+    if (flagTopDown)
+    {
+        height = -(int32_t)height;
+    }
+
+    // Uncompressed only
+    if ((compression != 0) or (planes != 1) or (width == 0) or (height == 0) or (width > 0xffff) or (height > 0xffff))
+    {
+        return RESULT_ERROR;
+    }
+
+    switch (bitsPerPixel)
+    {
+        case 1:
+        case 4:
+        case 8:
+        case 16:
+        case 24:
+        case 32:
+
+            break;
+
+        default:
+
+            return RESULT_ERROR;
+    }
+
+    // Palette, BGRA into 16-bit colours
+    uint16_t palette[256];
+    if (bitsPerPixel <= 8)
+    {
+        uint16_t number = (colours == 0) ? (1 << bitsPerPixel) : hV_HAL_min(colours, (uint32_t)256);
+        memset(palette, 0x00, sizeof(palette));
+
+        for (uint16_t k = 0; k < number; k++)
+        {
+            uint8_t blue, green, red, alpha;
+            if ((_getByte(blue) == RESULT_ERROR) or (_getByte(green) == RESULT_ERROR)
+                    or (_getByte(red) == RESULT_ERROR) or (_getByte(alpha) == RESULT_ERROR))
+            {
+                return RESULT_ERROR;
+            }
+            palette[k] = ((red >> 3) << 11) | ((green >> 2) << 5) | (blue >> 3);
+        }
+    }
+
+    // Pixel array
+    if ((offset < _report.bytes) or (_skip(offset - _report.bytes) == RESULT_ERROR))
+    {
+        return RESULT_ERROR;
+    }
+
+    _report.format = IMAGE_BMP;
+    _report.width = width;
+    _report.height = height;
+
+    // Rows padded to 4 bytes
+    uint32_t bytesRow = ((width * bitsPerPixel + 31) >> 5) << 2;
+    uint32_t bytesPadding = bytesRow - ((width * bitsPerPixel + 7) >> 3);
+
+    uint16_t chunk[IMAGE_CHUNK]; // 16-bit colours, or 1 bit per pixel
+    uint8_t value = 0;
+
+    for (uint32_t r = 0; r < height; r++)
+    {
+        uint32_t j = (flagTopDown) ? r : height - 1 - r;
+
+        for (uint32_t i = 0; i < width; i += IMAGE_CHUNK)
+        {
+            uint16_t number = hV_HAL_min(width - i, (uint32_t)IMAGE_CHUNK);
+
+            if (bitsPerPixel == 1)
+            {
+                uint8_t * chunk8 = (uint8_t *)chunk;
+                for (uint8_t k = 0; k < ((number + 7) >> 3); k++)
+                {
+                    if (_getByte(chunk8[k]) == RESULT_ERROR)
+                    {
+                        return RESULT_ERROR;
+                    }
+                }
+
+                if (x0 + i < 0x10000)
+                {
+                    _pScreen->drawBitmap(x0 + i, y0 + j, chunk8, number, 1, palette[1], palette[0]);
+                }
+                continue;
+            }
+
+            for (uint16_t k = 0; k < number; k++)
+            {
+                uint8_t bytes[4];
+
+                switch (bitsPerPixel)
+                {
+                    case 4:
+
+                        if ((k & 0x01) == 0)
+                        {
+                            if (_getByte(value) == RESULT_ERROR)
+                            {
+                                return RESULT_ERROR;
+                            }
+                            chunk[k] = palette[value >> 4];
+                        }
+                        else
+                        {
+                            chunk[k] = palette[value & 0x0f];
+                        }
+                        break;
+
+                    case 8:
+
+                        if (_getByte(value) == RESULT_ERROR)
+                        {
+                            return RESULT_ERROR;
+                        }
+                        chunk[k] = palette[value];
+                        break;
+
+                    default: // 16, 24 and 32
+
+                        for (uint8_t b = 0; b < (bitsPerPixel >> 3); b++)
+                        {
+                            if (_getByte(bytes[b]) == RESULT_ERROR)
+                            {
+                                return RESULT_ERROR;
+                            }
+                        }
+
+                        if (bitsPerPixel == 16)
+                        {
+                            // X1R5G5B5 into R5G6B5
+                            uint16_t colour = bytes[0] | (bytes[1] << 8);
+                            chunk[k] = ((colour << 1) & 0xffc0) | ((colour >> 4) & 0x0020) | (colour & 0x001f);
+                        }
+                        else
+                        {
+                            // BGR or BGRA
+                            chunk[k] = ((bytes[2] >> 3) << 11) | ((bytes[1] >> 2) << 5) | (bytes[0] >> 3);
+                        }
+                        break;
+                }
+            }
+
+            if (x0 + i < 0x10000)
+            {
+                _pScreen->drawBitmap(x0 + i, y0 + j, chunk, number, 1);
+            }
+        }
+
+        if (_skip(bytesPadding) == RESULT_ERROR)
+        {
+            return RESULT_ERROR;
+        }
+    }
+
+    return RESULT_SUCCESS;
+}
+
+bool Image::_getByte(uint8_t & value)
+{
+    if (_bufferIndex >= _bufferCount)
+    {
+        _bufferCount = _readBytes(_buffer, sizeof(_buffer), _context);
+        _bufferIndex = 0;
+        if (_bufferCount == 0)
+        {
+            return RESULT_ERROR;
+        }
+    }
+
+    value = _buffer[_bufferIndex];
+    _bufferIndex += 1;
+    _report.bytes += 1;
+    return RESULT_SUCCESS;
+}
+
+bool Image::_getNumberLE(uint8_t length, uint32_t & value)
+{
+    uint8_t byte;
+
+    value = 0;
+    for (uint8_t k = 0; k < length; k++)
+    {
+        if (_getByte(byte) == RESULT_ERROR)
+        {
+            return RESULT_ERROR;
+        }
+        value |= (uint32_t)byte << (8 * k);
+    }
+    return RESULT_SUCCESS;
+}
+
+bool Image::_getNumberASCII(uint32_t & value)
+{
+    uint8_t byte;
+
+    // Skip white spaces and comments
+    do
+    {
+        if (_getByte(byte) == RESULT_ERROR)
+        {
+            return RESULT_ERROR;
+        }
+        if (byte == '#')
+        {
+            while (byte != '\n')
+            {
+                if (_getByte(byte) == RESULT_ERROR)
+                {
+                    return RESULT_ERROR;
+                }
+            }
+        }
+    }
+    while ((byte == ' ') or (byte == '\t') or (byte == '\r') or (byte == '\n'));
+
+    if ((byte < '0') or (byte > '9'))
+    {
+        return RESULT_ERROR;
+    }
+
+    // Digits, then one white space consumed
+    value = 0;
+    while ((byte >= '0') and (byte <= '9'))
+    {
+        value = value * 10 + (byte - '0');
+        if ((value > 0xffff) or (_getByte(byte) == RESULT_ERROR))
+        {
+            return RESULT_ERROR;
+        }
+    }
+    return RESULT_SUCCESS;
+}
+
+bool Image::_skip(uint32_t length)
+{
+    uint8_t byte;
+
+    for (uint32_t k = 0; k < length; k++)
+    {
+        if (_getByte(byte) == RESULT_ERROR)
+        {
+            return RESULT_ERROR;
+        }
+    }
+    return RESULT_SUCCESS;
+}
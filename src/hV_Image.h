@@ -0,0 +1,192 @@
+///
+/// @file hV_Image.h
+/// @brief Streaming image decoder - Basic edition
+///
+/// @details Project Pervasive Displays Library Suite
+/// @n Based on highView technology
+///
+/// @date 21 Jul 2026
+/// @version 1009
+///
+/// @copyright (c) Pervasive Displays Inc., 2021-2026
+/// @copyright (c) Etigues, 2010-2026
+/// @copyright All rights reserved
+/// @copyright For exclusive use with Pervasive Displays screens
+///
+/// * Basic edition: for hobbyists and for basic usage
+/// @n Creative Commons Attribution-ShareAlike 4.0 International (CC BY-SA 4.0)
+/// @see https://creativecommons.org/licenses/by-sa/4.0/
+///
+/// @n Consider the Evaluation or Commercial editions for professionals or organisations and for commercial usage
+///
+/// * Evaluation edition: for professionals or organisations, evaluation only, no commercial usage
+/// @n All rights reserved
+///
+/// * Commercial edition: for professionals or organisations, commercial usage
+/// @n All rights reserved
+///
+/// * Viewer edition: for professionals or organisations
+/// @n All rights reserved
+///
+/// * Documentation
+/// @n All rights reserved
+///
+
+#ifndef hV_IMAGE_RELEASE
+///
+/// @brief Library release number
+///
+#define hV_IMAGE_RELEASE 1009
+
+// SDK and configuration
+#include "PDLS_Common.h"
+
+#if (PDLS_COMMON_RELEASE < 1000)
+#error Required PDLS_COMMON_RELEASE 1000
+#endif // PDLS_COMMON_RELEASE
+
+// Other libraries
+#include "Screen_EPD.h"
+
+#if (SCREEN_EPD_RELEASE < 1009)
+#error Required SCREEN_EPD_RELEASE 1009
+#endif // SCREEN_EPD_RELEASE
+
+///
+/// @name Image formats
+/// @{
+#define IMAGE_NONE 0 ///< Unknown or unsupported format
+#define IMAGE_PBM 1 ///< Binary PBM, P4, 1 bit per pixel
+#define IMAGE_PGM 2 ///< Binary PGM, P5, 8 bits per pixel, dithered
+#define IMAGE_BMP 3 ///< Uncompressed BMP, 1, 4, 8, 16, 24 or 32 bits per pixel
+/// @}
+
+///
+/// @brief Read bytes from a stream
+/// @param buffer buffer to fill
+/// @param length number of bytes requested
+/// @param context context provided to Image::decode(), for example a file
+/// @return number of bytes read, `0` at end of stream
+///
+typedef uint16_t (* readBytes_t)(uint8_t * buffer, uint16_t length, void * context);
+
+///
+/// @brief Stream from memory
+/// @details Context for Image::readMemory(), stand-in for a file or a serial port
+///
+struct imageMemory_s
+{
+    const uint8_t * data; ///< image data
+    uint32_t size; ///< size of image data
+    uint32_t position; ///< next byte to read
+};
+
+///
+/// @brief Report on last decoding
+///
+struct imageReport_s
+{
+    uint8_t format; ///< IMAGE_PBM, IMAGE_PGM, IMAGE_BMP or IMAGE_NONE
+    uint16_t width; ///< image width, pixels
+    uint16_t height; ///< image height, pixels
+    uint32_t bytes; ///< bytes read from the stream
+    uint32_t milliseconds; ///< decoding duration, ms
+    uint32_t bytesPerSecond; ///< decoding throughput, bytes per second
+};
+
+///
+/// @class Image
+/// @brief Streaming image decoder
+/// @details Images decoded row by row into the frame-buffer, no decoded copy
+/// @note Memory used: input buffer, chunk of pixels, palette for BMP
+///
+class Image
+{
+  public:
+    ///
+    /// @brief Constructor
+    /// @param screen &screen to draw the images on
+    ///
+    Image(Screen_EPD * screen);
+
+    ///
+    /// @brief Decode an image from a stream
+    /// @param readBytes function to read bytes from the stream
+    /// @param context context for readBytes, for example a file
+    /// @param x0 top left coordinate, x-axis, default = 0
+    /// @param y0 top left coordinate, y-axis, default = 0
+    /// @return `RESULT_SUCCESS` = false = success, `RESULT_ERROR` = true = error
+    /// @note Format recognised from the signature: PBM P4, PGM P5 or BMP
+    /// @note PGM grey levels and BMP colours dithered as set by Screen_EPD::setDither(), PGM with `DITHER_4X4` if none set
+    /// @note Rows outside the screen are read but not drawn
+    /// @note Fastest with default orientation and x0 multiple of 8
+    ///
+    bool decode(readBytes_t readBytes, void * context, uint16_t x0 = 0, uint16_t y0 = 0);
+
+    ///
+    /// @brief Get report on last decoding
+    /// @return report with format, size, bytes read and throughput
+    ///
+    imageReport_s getReport();
+
+    ///
+    /// @brief Read bytes from memory
+    /// @param buffer buffer to fill
+    /// @param length number of bytes requested
+    /// @param context &imageMemory_s
+    /// @return number of bytes read
+    ///
+    static uint16_t readMemory(uint8_t * buffer, uint16_t length, void * context);
+
+  protected:
+    /// @cond
+    ///
+    /// @brief Decode PBM P4 or PGM P5 after signature
+    ///
+    bool _decodePNM(uint8_t format, uint16_t x0, uint16_t y0);
+
+    ///
+    /// @brief Decode BMP after signature
+    ///
+    bool _decodeBMP(uint16_t x0, uint16_t y0);
+
+    ///
+    /// @brief Get one byte from the input buffer
+    /// @param[out] value byte
+    /// @return `RESULT_SUCCESS` or `RESULT_ERROR` at end of stream
+    ///
+    bool _getByte(uint8_t & value);
+
+    ///
+    /// @brief Get unsigned little endian number
+    /// @param length number of bytes, 1 to 4
+    /// @param[out] value number
+    /// @return `RESULT_SUCCESS` or `RESULT_ERROR` at end of stream
+    ///
+    bool _getNumberLE(uint8_t length, uint32_t & value);
+
+    ///
+    /// @brief Get ASCII decimal number, PNM header
+    /// @param[out] value number
+    /// @return `RESULT_SUCCESS` or `RESULT_ERROR`
+    /// @note Skip white spaces and comments before the number
+    ///
+    bool _getNumberASCII(uint32_t & value);
+
+    ///
+    /// @brief Skip bytes
+    /// @param length number of bytes to skip
+    /// @return `RESULT_SUCCESS` or `RESULT_ERROR` at end of stream
+    ///
+    bool _skip(uint32_t length);
+
+    Screen_EPD * _pScreen;
+    readBytes_t _readBytes;
+    void * _context;
+    uint8_t _buffer[64]; ///< input buffer
+    uint8_t _bufferCount, _bufferIndex;
+    imageReport_s _report;
+    /// @endcond
+};
+
+#endif // hV_IMAGE_RELEASE
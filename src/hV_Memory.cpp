@@ -0,0 +1,115 @@
+//
+// hV_Memory.cpp
+// Library C++ code
+// ----------------------------------
+//
+// Project Pervasive Displays Library Suite
+// Based on highView technology
+//
+// Created by Rei Vilo, 21 Jul 2026
+//
+// Copyright (c) Pervasive Displays Inc., 2021-2026
+// Copyright (c) Etigues, 2010-2026
+// Licence Creative Commons Attribution-ShareAlike 4.0 International (CC BY-SA 4.0)
+// For exclusive use with Pervasive Displays screens
+//
+// See hV_Memory.h for references
+//
+// Release 1009: Added external memory with stand-in in internal RAM
+//
+
+// Library header
+#include "hV_Memory.h"
+
+// Allocation without exception
+#include <new>
+
+Memory_Virtual::~Memory_Virtual()
+{
+    ;
+}
+
+Memory_RAM::Memory_RAM()
+{
+    u_data = 0; // nullptr
+    u_size = 0;
+    resetCounters();
+}
+
+Memory_RAM::~Memory_RAM()
+{
+    end();
+}
+
+bool Memory_RAM::begin(uint32_t size)
+{
+    end();
+
+    u_data = new (std::nothrow) uint8_t[size];
+    if (u_data == 0)
+    {
+        hV_HAL_log(LEVEL_ERROR, "Memory not created");
+        return RESULT_ERROR;
+    }
+
+    u_size = size;
+    memset(u_data, 0x00, u_size);
+    resetCounters();
+    return RESULT_SUCCESS;
+}
+
+void Memory_RAM::end()
+{
+    delete[] u_data;
+    u_data = 0; // nullptr
+    u_size = 0;
+}
+
+void Memory_RAM::read(uint32_t address, uint8_t * data, uint32_t size)
+{
+    u_transactions += 1;
+    u_bytesRead += size;
+
+    if (address < u_size)
+    {
+        memcpy(data, u_data + address, hV_HAL_min(size, u_size - address));
+    }
+}
+
+void Memory_RAM::write(uint32_t address, const uint8_t * data, uint32_t size)
+{
+    u_transactions += 1;
+    u_bytesWritten += size;
+
+    if (address < u_size)
+    {
+        memcpy(u_data + address, data, hV_HAL_min(size, u_size - address));
+    }
+}
+
+void Memory_RAM::resetCounters()
+{
+    u_transactions = 0;
+    u_bytesRead = 0;
+    u_bytesWritten = 0;
+}
+
+uint32_t Memory_RAM::transactions()
+{
+    return u_transactions;
+}
+
+uint32_t Memory_RAM::bytesRead()
+{
+    return u_bytesRead;
+}
+
+uint32_t Memory_RAM::bytesWritten()
+{
+    return u_bytesWritten;
+}
+
+const uint8_t * Memory_RAM::data()
+{
+    return u_data;
+}
@@ -0,0 +1,169 @@
+///
+/// @file hV_Memory.h
+/// @brief External memory for the frame-buffer - Basic edition
+///
+/// @details Project Pervasive Displays Library Suite
+/// @n Based on highView technology
+///
+/// @date 21 Jul 2026
+/// @version 1009
+///
+/// @copyright (c) Pervasive Displays Inc., 2021-2026
+/// @copyright (c) Etigues, 2010-2026
+/// @copyright All rights reserved
+/// @copyright For exclusive use with Pervasive Displays screens
+///
+/// * Basic edition: for hobbyists and for basic usage
+/// @n Creative Commons Attribution-ShareAlike 4.0 International (CC BY-SA 4.0)
+/// @see https://creativecommons.org/licenses/by-sa/4.0/
+///
+/// @n Consider the Evaluation or Commercial editions for professionals or organisations and for commercial usage
+///
+/// * Evaluation edition: for professionals or organisations, evaluation only, no commercial usage
+/// @n All rights reserved
+///
+/// * Commercial edition: for professionals or organisations, commercial usage
+/// @n All rights reserved
+///
+/// * Viewer edition: for professionals or organisations
+/// @n All rights reserved
+///
+/// * Documentation
+/// @n All rights reserved
+///
+
+#ifndef hV_MEMORY_RELEASE
+///
+/// @brief Library release number
+///
+#define hV_MEMORY_RELEASE 1009
+
+// SDK and configuration
+#include "PDLS_Common.h"
+
+#if (PDLS_COMMON_RELEASE < 1000)
+#error Required PDLS_COMMON_RELEASE 1000
+#endif // PDLS_COMMON_RELEASE
+
+///
+/// @class Memory_Virtual
+/// @brief External memory, interface
+/// @details Transfers of contiguous bytes, one transaction per call
+/// @note For an external SPI SRAM, each call is one command with address and data
+///
+class Memory_Virtual
+{
+  public:
+    ///
+    /// @brief Destructor
+    ///
+    virtual ~Memory_Virtual();
+
+    ///
+    /// @brief Read bytes
+    /// @param address first byte in memory
+    /// @param data buffer to read into
+    /// @param size number of bytes
+    ///
+    virtual void read(uint32_t address, uint8_t * data, uint32_t size) = 0;
+
+    ///
+    /// @brief Write bytes
+    /// @param address first byte in memory
+    /// @param data bytes to write
+    /// @param size number of bytes
+    ///
+    virtual void write(uint32_t address, const uint8_t * data, uint32_t size) = 0;
+};
+
+///
+/// @class Memory_RAM
+/// @brief External memory, stand-in in internal RAM
+/// @details Same interface as an external memory, with count of transactions and bytes
+/// @note For tests and for measures of the traffic on the bus
+///
+class Memory_RAM : public Memory_Virtual
+{
+  public:
+    ///
+    /// @brief Constructor
+    ///
+    Memory_RAM();
+
+    ///
+    /// @brief Destructor
+    /// @note Memory released with end()
+    ///
+    ~Memory_RAM();
+
+    ///
+    /// @brief Initialise the memory
+    /// @param size size, in bytes
+    /// @return `RESULT_SUCCESS` = false = success, `RESULT_ERROR` = true = error
+    /// @note Memory filled with 0x00, counters reset
+    ///
+    bool begin(uint32_t size);
+
+    ///
+    /// @brief Release the memory
+    ///
+    void end();
+
+    ///
+    /// @brief Read bytes
+    /// @param address first byte in memory
+    /// @param data buffer to read into
+    /// @param size number of bytes
+    /// @note Bytes beyond the memory ignored
+    ///
+    void read(uint32_t address, uint8_t * data, uint32_t size);
+
+    ///
+    /// @brief Write bytes
+    /// @param address first byte in memory
+    /// @param data bytes to write
+    /// @param size number of bytes
+    /// @note Bytes beyond the memory ignored
+    ///
+    void write(uint32_t address, const uint8_t * data, uint32_t size);
+
+    ///
+    /// @brief Reset the counters
+    ///
+    void resetCounters();
+
+    ///
+    /// @brief Number of transactions
+    /// @return read and write calls since last reset
+    ///
+    uint32_t transactions();
+
+    ///
+    /// @brief Number of bytes read
+    /// @return bytes since last reset
+    ///
+    uint32_t bytesRead();
+
+    ///
+    /// @brief Number of bytes written
+    /// @return bytes since last reset
+    ///
+    uint32_t bytesWritten();
+
+    ///
+    /// @brief Content of the memory
+    /// @return first byte, nullptr if none
+    ///
+    const uint8_t * data();
+
+  protected:
+    /// @cond
+    uint8_t * u_data;
+    uint32_t u_size;
+    uint32_t u_transactions;
+    uint32_t u_bytesRead;
+    uint32_t u_bytesWritten;
+    /// @endcond
+};
+
+#endif // hV_MEMORY_RELEASE
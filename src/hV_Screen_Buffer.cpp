@@ -24,11 +24,30 @@
 // Release 805: Added large variant for gText()
 // Release 910: Added check on vector coordinates
 // Release 1000: Added support for UTF-8 strings
+// Release 1002: Added spans for lines and rectangles
+// Release 1002: Added block fill for solid rectangles
+// Release 1002: Added bitmaps
+// Release 1002: Added read of pixel
+// Release 1002: Added character hook for gText()
+// Release 1002: Added scales for gTextLarge()
+// Release 1002: Added iterator on text for gText() and gTextLarge()
+// Release 1002: Added text box
+// Release 1002: Added glyphs of compact fonts for text
+// Release 1002: Added ellipses and rounded rectangles filled by spans
+// Release 1002: Added scanline polygons, triangles without delays
+// Release 1002: Added clipping of lines, rectangles and polygons before drawing
+// Release 1002: Added stack of clip rectangles
+// Release 1002: Added display list with replay into regions
+// Release 1002: Added immediate mode of display list for external memory
+// Release 1002: Kept polygon scratch between calls
 //
 
 // Library header
 #include "hV_Screen_Buffer.h"
 
+// Allocation without exception
+#include <new>
+
 // Code
 hV_Screen_Buffer::hV_Screen_Buffer()
 {
@@ -40,6 +59,13 @@ hV_Screen_Buffer::hV_Screen_Buffer()
     v_penSolid = false; // default
 }
 
+hV_Screen_Buffer::~hV_Screen_Buffer()
+{
+    delete[] v_polygonEdges;
+    delete[] v_polygonActive;
+    delete[] v_polygonBuffer;
+}
+
 void hV_Screen_Buffer::begin()
 {
     f_begin(); // hV_Font_...
@@ -47,13 +73,28 @@ void hV_Screen_Buffer::begin()
 
 void hV_Screen_Buffer::clear(uint16_t colour)
 {
+    if (v_listRecord)
+    {
+        s_listRecord(LIST_CLEAR, 0, 0, screenSizeX() - 1, screenSizeY() - 1, &colour, 1);
+        return;
+    }
+
     uint8_t oldOrientation = v_orientation;
     bool oldPenSolid = v_penSolid;
+    uint16_t oldClip[4] = { v_clipX1, v_clipY1, v_clipX2, v_clipY2 };
+    uint8_t oldClipDepth = v_clipDepth;
     setOrientation(0);
     setPenSolid();
     rectangle(0, 0, screenSizeX() - 1, screenSizeY() - 1, colour);
     setOrientation(oldOrientation);
     setPenSolid(oldPenSolid);
+
+    // Clip rectangles kept
+    v_clipX1 = oldClip[0];
+    v_clipY1 = oldClip[1];
+    v_clipX2 = oldClip[2];
+    v_clipY2 = oldClip[3];
+    v_clipDepth = oldClipDepth;
 }
 
 void hV_Screen_Buffer::flush()
@@ -88,6 +129,8 @@ void hV_Screen_Buffer::setOrientation(uint8_t orientation)
             s_setOrientation(orientation);
             break;
     }
+
+    s_resetClip();
 }
 
 uint8_t hV_Screen_Buffer::getOrientation()
@@ -145,8 +188,65 @@ uint8_t hV_Screen_Buffer::screenColourBits()
     return v_screenColourBits;
 }
 
+bool hV_Screen_Buffer::pushClip(uint16_t x0, uint16_t y0, uint16_t dx, uint16_t dy)
+{
+    if (v_clipDepth >= MAX_CLIP_DEPTH)
+    {
+        hV_HAL_log(LEVEL_ERROR, "Too many clip rectangles");
+        return RESULT_ERROR;
+    }
+
+    v_clipStack[v_clipDepth][0] = v_clipX1;
+    v_clipStack[v_clipDepth][1] = v_clipY1;
+    v_clipStack[v_clipDepth][2] = v_clipX2;
+    v_clipStack[v_clipDepth][3] = v_clipY2;
+    v_clipDepth += 1;
+
+    // Intersection with the current clip rectangle, empty if first > last
+    int32_t x1 = hV_HAL_max((int32_t)x0, (int32_t)v_clipX1);
+    int32_t y1 = hV_HAL_max((int32_t)y0, (int32_t)v_clipY1);
+    int32_t x2 = hV_HAL_min((int32_t)x0 + dx - 1, (int32_t)v_clipX2);
+    int32_t y2 = hV_HAL_min((int32_t)y0 + dy - 1, (int32_t)v_clipY2);
+
+    if ((x1 > x2) or (y1 > y2))
+    {
+        x1 = 1;
+        y1 = 1;
+        x2 = 0;
+        y2 = 0;
+    }
+
+    v_clipX1 = x1;
+    v_clipY1 = y1;
+    v_clipX2 = x2;
+    v_clipY2 = y2;
+    return RESULT_SUCCESS;
+}
+
+bool hV_Screen_Buffer::popClip()
+{
+    if (v_clipDepth == 0)
+    {
+        return RESULT_ERROR;
+    }
+
+    v_clipDepth -= 1;
+    v_clipX1 = v_clipStack[v_clipDepth][0];
+    v_clipY1 = v_clipStack[v_clipDepth][1];
+    v_clipX2 = v_clipStack[v_clipDepth][2];
+    v_clipY2 = v_clipStack[v_clipDepth][3];
+    return RESULT_SUCCESS;
+}
+
 void hV_Screen_Buffer::circle(uint16_t x0, uint16_t y0, uint16_t radius, uint16_t colour)
 {
+    if (v_listRecord)
+    {
+        uint16_t values[] = { x0, y0, radius, colour };
+        s_listRecord(LIST_CIRCLE, (int32_t)x0 - radius, (int32_t)y0 - radius, (int32_t)x0 + radius, (int32_t)y0 + radius, values, 4);
+        return;
+    }
+
     int16_t f = 1 - radius;
     int16_t ddF_x = 1;
     int16_t ddF_y = -2 * radius;
@@ -155,6 +255,13 @@ void hV_Screen_Buffer::circle(uint16_t x0, uint16_t y0, uint16_t radius, uint16_
 
     if (v_penSolid == false)
     {
+        // Each pixel plotted once
+        if (radius == 0)
+        {
+            point(x0, y0, colour);
+            return;
+        }
+
         point(x0, y0 + radius, colour);
         point(x0, y0 - radius, colour);
         point(x0 + radius, y0, colour);
@@ -173,22 +280,40 @@ void hV_Screen_Buffer::circle(uint16_t x0, uint16_t y0, uint16_t radius, uint16_
             ddF_x += 2;
             f += ddF_x;
 
+            if (x > y)
+            {
+                break; // same pixels as previous step
+            }
+
             point(x0 + x, y0 + y, colour);
             point(x0 - x, y0 + y, colour);
             point(x0 + x, y0 - y, colour);
             point(x0 - x, y0 - y, colour);
-            point(x0 + y, y0 + x, colour);
-            point(x0 - y, y0 + x, colour);
-            point(x0 + y, y0 - x, colour);
-            point(x0 - y, y0 - x, colour);
+
+            if (x < y)
+            {
+                point(x0 + y, y0 + x, colour);
+                point(x0 - y, y0 + x, colour);
+                point(x0 + y, y0 - x, colour);
+                point(x0 - y, y0 - x, colour);
+            }
         }
     }
     else
     {
+        // Each row filled once with one span
         while (x < y)
         {
+            // Row x, half-width y
+            s_setCircleRows(x0, y0, x, y, colour);
+
             if (f >= 0)
             {
+                // Row y, half-width x, last step on that row
+                if (y > x + 1)
+                {
+                    s_setCircleRows(x0, y0, y, x, colour);
+                }
                 y--;
                 ddF_y += 2;
                 f += ddF_y;
@@ -197,63 +322,235 @@ void hV_Screen_Buffer::circle(uint16_t x0, uint16_t y0, uint16_t radius, uint16_
             x++;
             ddF_x += 2;
             f += ddF_x;
-
-            line(x0 + x, y0 + y, x0 - x, y0 + y, colour); // bottom
-            line(x0 + x, y0 - y, x0 - x, y0 - y, colour); // top
-            line(x0 + y, y0 - x, x0 + y, y0 + x, colour); // right
-            line(x0 - y, y0 - x, x0 - y, y0 + x, colour); // left
         }
+        s_setCircleRows(x0, y0, x, y, colour);
+    }
+}
+
+void hV_Screen_Buffer::ellipse(uint16_t x0, uint16_t y0, uint16_t radiusX, uint16_t radiusY, uint16_t colour)
+{
+    if (v_listRecord)
+    {
+        uint16_t values[] = { x0, y0, radiusX, radiusY, colour };
+        s_listRecord(LIST_ELLIPSE, (int32_t)x0 - radiusX, (int32_t)y0 - radiusY, (int32_t)x0 + radiusX, (int32_t)y0 + radiusY, values, 5);
+        return;
+    }
+
+    s_roundedArea((int32_t)x0 - radiusX, (int32_t)y0 - radiusY, (int32_t)x0 + radiusX, (int32_t)y0 + radiusY,
+                  radiusX, radiusY, colour);
+}
+
+void hV_Screen_Buffer::roundedRectangle(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2, uint16_t radius, uint16_t colour)
+{
+    if (v_listRecord)
+    {
+        uint16_t values[] = { x1, y1, x2, y2, radius, colour };
+        s_listRecord(LIST_ROUNDED, x1, y1, x2, y2, values, 6);
+        return;
+    }
 
-        setPenSolid(true);
-        rectangle(x0 - x, y0 - y, x0 + x, y0 + y, colour);
+    if (x1 > x2)
+    {
+        hV_HAL_swap(x1, x2);
+    }
+    if (y1 > y2)
+    {
+        hV_HAL_swap(y1, y2);
     }
+
+    // Corners up to half the shorter side
+    radius = hV_HAL_min(radius, (uint16_t)(hV_HAL_min((uint16_t)(x2 - x1), (uint16_t)(y2 - y1)) / 2));
+    s_roundedArea(x1, y1, x2, y2, radius, radius, colour);
 }
 
-void hV_Screen_Buffer::dLine(uint16_t x0, uint16_t y0, uint16_t dx, uint16_t dy, uint16_t colour)
+void hV_Screen_Buffer::dRoundedRectangle(uint16_t x0, uint16_t y0, uint16_t dx, uint16_t dy, uint16_t radius, uint16_t colour)
 {
     if ((dx == 0) or (dy == 0))
     {
         return;
     }
 
-    line(x0, y0, x0 + dx - 1, y0 + dy - 1, colour);
+    roundedRectangle(x0, y0, x0 + dx - 1, y0 + dy - 1, radius, colour);
 }
 
-void hV_Screen_Buffer::line(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2, uint16_t colour)
+void hV_Screen_Buffer::s_setCircleRows(uint16_t x0, uint16_t y0, uint16_t dy, uint16_t dx, uint16_t colour)
 {
-    if ((x1 == x2) and (y1 == y2))
+    s_setClippedArea((int32_t)x0 - dx, (int32_t)y0 - dy, (int32_t)x0 + dx, (int32_t)y0 - dy, colour);
+    if (dy > 0)
     {
-        s_setPoint(x1, y1, colour);
+        s_setClippedArea((int32_t)x0 - dx, (int32_t)y0 + dy, (int32_t)x0 + dx, (int32_t)y0 + dy, colour);
     }
-    else if (x1 == x2)
+}
+
+void hV_Screen_Buffer::s_roundedArea(int32_t x1, int32_t y1, int32_t x2, int32_t y2, uint16_t radiusX, uint16_t radiusY, uint16_t colour)
+{
+    // Centres of the corners
+    int32_t xL = x1 + radiusX;
+    int32_t xR = x2 - radiusX;
+    int32_t yT = y1 + radiusY;
+    int32_t yB = y2 - radiusY;
+
+    // Pixel (x, y) inside if (x / (radiusX + 0.5))^2 + (y / (radiusY + 0.5))^2 <= 1, scaled by 2
+    int64_t a2 = (int64_t)(2 * radiusX + 1) * (2 * radiusX + 1);
+    int64_t b2 = (int64_t)(2 * radiusY + 1) * (2 * radiusY + 1);
+    int64_t limit = a2 * b2;
+
+    // Straight part between the corners
+    if (yB - yT > 1)
     {
-        if (y1 > y2)
+        if (v_penSolid)
         {
-            hV_HAL_swap(y1, y2);
+            s_setClippedArea(x1, yT + 1, x2, yB - 1, colour);
         }
-        for (uint16_t y = y1; y <= y2; y++)
+        else
         {
-            s_setPoint(x1, y, colour);
+            s_setClippedArea(x1, yT + 1, x1, yB - 1, colour);
+            s_setClippedArea(x2, yT + 1, x2, yB - 1, colour);
         }
     }
-    else if (y1 == y2)
+
+    // Rows of the corners, half-width decreasing from radiusX
+    int32_t width = radiusX;
+    for (int32_t dy = 0; dy <= radiusY; dy++)
     {
-        if (x1 > x2)
+        int32_t widthNext = width;
+        int64_t rowNext = 4 * (int64_t)(dy + 1) * (dy + 1) * a2;
+        while ((widthNext >= 0) and (4 * (int64_t)widthNext * widthNext * b2 + rowNext > limit))
         {
-            hV_HAL_swap(x1, x2);
+            widthNext -= 1;
         }
-        for (uint16_t x = x1; x <= x2; x++)
+
+        for (uint8_t k = 0; k < 2; k++)
         {
-            s_setPoint(x, y1, colour);
+            int32_t y = (k == 0) ? yT - dy : yB + dy;
+            if ((k == 1) and (yB + dy == yT - dy))
+            {
+                break; // same row
+            }
+
+            if (v_penSolid)
+            {
+                s_setClippedArea(xL - width, y, xR + width, y, colour);
+            }
+            else
+            {
+                // From next row outwards, at least one pixel
+                int32_t inner = hV_HAL_min(widthNext + 1, width);
+                if (inner == 0)
+                {
+                    s_setClippedArea(xL - width, y, xR + width, y, colour);
+                }
+                else
+                {
+                    s_setClippedArea(xL - width, y, xL - inner, y, colour);
+                    s_setClippedArea(xR + inner, y, xR + width, y, colour);
+                }
+            }
         }
+        width = widthNext;
+    }
+}
+
+void hV_Screen_Buffer::s_setClippedArea(int32_t x1, int32_t y1, int32_t x2, int32_t y2, uint16_t colour)
+{
+    if (x1 > x2)
+    {
+        hV_HAL_swap(x1, x2);
+    }
+    if (y1 > y2)
+    {
+        hV_HAL_swap(y1, y2);
+    }
+    if ((x2 < 0) or (y2 < 0))
+    {
+        return;
+    }
+    x1 = hV_HAL_max(x1, (int32_t)v_clipX1);
+    y1 = hV_HAL_max(y1, (int32_t)v_clipY1);
+    x2 = hV_HAL_min(x2, (int32_t)v_clipX2);
+    y2 = hV_HAL_min(y2, (int32_t)v_clipY2);
+    if ((x1 > x2) or (y1 > y2))
+    {
+        return;
+    }
+
+    if (y1 == y2)
+    {
+        s_setSpanX(x1, x2, y1, colour);
+    }
+    else if (x1 == x2)
+    {
+        s_setSpanY(x1, y1, y2, colour);
     }
     else
     {
-        int16_t wx1 = (int16_t)x1;
-        int16_t wx2 = (int16_t)x2;
-        int16_t wy1 = (int16_t)y1;
-        int16_t wy2 = (int16_t)y2;
+        s_setRectangle(x1, y1, x2, y2, colour);
+    }
+}
+
+bool hV_Screen_Buffer::s_clipArea(uint16_t & x1, uint16_t & y1, uint16_t & x2, uint16_t & y2)
+{
+    if (x1 > x2)
+    {
+        hV_HAL_swap(x1, x2);
+    }
+    if (y1 > y2)
+    {
+        hV_HAL_swap(y1, y2);
+    }
+
+    x1 = hV_HAL_max(x1, v_clipX1);
+    y1 = hV_HAL_max(y1, v_clipY1);
+    x2 = hV_HAL_min(x2, v_clipX2);
+    y2 = hV_HAL_min(y2, v_clipY2);
+
+    return ((x1 > x2) or (y1 > y2)) ? RESULT_ERROR : RESULT_SUCCESS;
+}
+
+void hV_Screen_Buffer::s_resetClip()
+{
+    v_clipDepth = 0;
+    v_clipX1 = 0;
+    v_clipY1 = 0;
+    v_clipX2 = screenSizeX() - 1;
+    v_clipY2 = screenSizeY() - 1;
+}
+
+void hV_Screen_Buffer::dLine(uint16_t x0, uint16_t y0, uint16_t dx, uint16_t dy, uint16_t colour)
+{
+    if ((dx == 0) or (dy == 0))
+    {
+        return;
+    }
+
+    line(x0, y0, x0 + dx - 1, y0 + dy - 1, colour);
+}
+
+void hV_Screen_Buffer::line(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2, uint16_t colour)
+{
+    if (v_listRecord)
+    {
+        uint16_t values[] = { x1, y1, x2, y2, colour };
+        s_listRecord(LIST_LINE, (int16_t)x1, (int16_t)y1, (int16_t)x2, (int16_t)y2, values, 5);
+        return;
+    }
+
+    // Coordinates above 0x7fff negative, as x0 - radius
+    int32_t wx1 = (int16_t)x1;
+    int32_t wx2 = (int16_t)x2;
+    int32_t wy1 = (int16_t)y1;
+    int32_t wy2 = (int16_t)y2;
 
+    if ((wx1 == wx2) and (wy1 == wy2))
+    {
+        s_setPoint(x1, y1, colour);
+    }
+    else if ((wx1 == wx2) or (wy1 == wy2))
+    {
+        s_setClippedArea(wx1, wy1, wx2, wy2, colour);
+    }
+    else
+    {
         bool flag = abs(wy2 - wy1) > abs(wx2 - wx1);
         if (flag)
         {
@@ -267,29 +564,48 @@ void hV_Screen_Buffer::line(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2,
             hV_HAL_swap(wy1, wy2);
         }
 
-        int16_t dx = wx2 - wx1;
-        int16_t dy = abs(wy2 - wy1);
-        int16_t err = dx / 2;
-        int16_t ystep;
-
-        if (wy1 < wy2)
+        int32_t dx = wx2 - wx1;
+        int32_t dy = abs(wy2 - wy1);
+        int32_t err = dx / 2;
+        int32_t ystep = (wy1 < wy2) ? 1 : -1;
+
+        // Clipped once, steps n = 0..dx along major axis, minor axis moved k(n) = ceil((n * dy - err) / dx) times
+        int32_t firstMajor = (flag) ? v_clipY1 : v_clipX1;
+        int32_t lastMajor = (flag) ? v_clipY2 : v_clipX2;
+        int32_t firstMinor = (flag) ? v_clipX1 : v_clipY1;
+        int32_t lastMinor = (flag) ? v_clipX2 : v_clipY2;
+        int32_t nFirst = hV_HAL_max((int32_t)0, firstMajor - wx1);
+        int32_t nLast = hV_HAL_min(dx, lastMajor - wx1);
+        int32_t kFirst = (ystep > 0) ? firstMinor - wy1 : wy1 - lastMinor;
+        int32_t kLast = (ystep > 0) ? lastMinor - wy1 : wy1 - firstMinor;
+        kFirst = hV_HAL_max(kFirst, (int32_t)0);
+        if ((nFirst > nLast) or (kFirst > kLast))
         {
-            ystep = 1;
+            return;
         }
-        else
+        if (kFirst > 0)
+        {
+            nFirst = hV_HAL_max(nFirst, (int32_t)((((int64_t)kFirst - 1) * dx + err) / dy + 1));
+        }
+        nLast = hV_HAL_min(nLast, (int32_t)(((int64_t)kLast * dx + err) / dy));
+        if (nFirst > nLast)
         {
-            ystep = -1;
+            return;
         }
 
-        for (; wx1 <= wx2; wx1++)
+        int32_t k = (int32_t)(((int64_t)nFirst * dy - err + dx - 1) / dx);
+        err = (int32_t)(err - (int64_t)nFirst * dy + (int64_t)k * dx);
+        wy1 += ystep * k;
+
+        for (wx1 += nFirst; nFirst <= nLast; nFirst++, wx1++)
         {
             if (flag)
             {
-                s_setPoint(wy1, wx1, colour);
+                s_setPointInside(wy1, wx1, colour);
             }
             else
             {
-                s_setPoint(wx1, wy1, colour);
+                s_setPointInside(wx1, wy1, colour);
             }
 
             err -= dy;
@@ -307,13 +623,37 @@ void hV_Screen_Buffer::setPenSolid(bool flag)
     v_penSolid = flag;
 }
 
+bool hV_Screen_Buffer::getPenSolid()
+{
+    return v_penSolid;
+}
+
 void hV_Screen_Buffer::point(uint16_t x1, uint16_t y1, uint16_t colour)
 {
+    if (v_listRecord)
+    {
+        uint16_t values[] = { x1, y1, colour };
+        s_listRecord(LIST_POINT, x1, y1, x1, y1, values, 3);
+        return;
+    }
+
     s_setPoint(x1, y1, colour);
 }
 
+uint16_t hV_Screen_Buffer::readPixel(uint16_t x1, uint16_t y1)
+{
+    return s_getPoint(x1, y1);
+}
+
 void hV_Screen_Buffer::rectangle(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2, uint16_t colour)
 {
+    if (v_listRecord)
+    {
+        uint16_t values[] = { x1, y1, x2, y2, colour };
+        s_listRecord(LIST_RECTANGLE, (int16_t)x1, (int16_t)y1, (int16_t)x2, (int16_t)y2, values, 5);
+        return;
+    }
+
     if (v_penSolid == false)
     {
         line(x1, y1, x1, y2, colour);
@@ -323,202 +663,466 @@ void hV_Screen_Buffer::rectangle(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t
     }
     else
     {
-        if (x1 > x2)
-        {
-            hV_HAL_swap(x1, x2);
-        }
-        if (y1 > y2)
-        {
-            hV_HAL_swap(y1, y2);
-        }
-        for (uint16_t x = x1; x <= x2; x++)
-        {
-            for (uint16_t y = y1; y <= y2; y++)
-            {
-                s_setPoint(x, y, colour);
-            }
-        }
+        s_setClippedArea((int16_t)x1, (int16_t)y1, (int16_t)x2, (int16_t)y2, colour);
     }
 }
 
-void hV_Screen_Buffer::dRectangle(uint16_t x0, uint16_t y0, uint16_t dx, uint16_t dy, uint16_t colour)
+void hV_Screen_Buffer::s_setPointInside(uint16_t x1, uint16_t y1, uint16_t colour)
 {
-    if ((dx == 0) or (dy == 0))
+    s_setPoint(x1, y1, colour);
+}
+
+void hV_Screen_Buffer::s_setRectangle(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2, uint16_t colour)
+{
+    if (s_clipArea(x1, y1, x2, y2) == RESULT_ERROR)
     {
         return;
     }
 
-    rectangle(x0, y0, x0 + dx - 1, y0 + dy - 1, colour);
+    for (uint16_t y = y1; y <= y2; y++)
+    {
+        s_setSpanX(x1, x2, y, colour);
+    }
 }
 
-void hV_Screen_Buffer::s_triangleArea(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2, uint16_t x3, uint16_t y3, uint16_t colour)
+void hV_Screen_Buffer::s_setSpanX(uint16_t x1, uint16_t x2, uint16_t y1, uint16_t colour)
 {
-    int16_t wx1 = (int16_t)x1;
-    int16_t wy1 = (int16_t)y1;
-    int16_t wx2 = (int16_t)x2;
-    int16_t wy2 = (int16_t)y2;
-    int16_t wx3 = (int16_t)x3;
-    int16_t wy3 = (int16_t)y3;
-    int16_t wx4 = wx1;
-    int16_t wy4 = wy1;
-    int16_t wx5 = wx1;
-    int16_t wy5 = wy1;
+    if (x1 > x2)
+    {
+        hV_HAL_swap(x1, x2);
+    }
+    if ((y1 < v_clipY1) or (y1 > v_clipY2))
+    {
+        return;
+    }
+    x1 = hV_HAL_max(x1, v_clipX1);
+    x2 = hV_HAL_min(x2, v_clipX2);
+
+    for (uint16_t x = x1; x <= x2; x++)
+    {
+        s_setPoint(x, y1, colour);
+    }
+}
 
-    bool changed1 = false;
-    bool changed2 = false;
+void hV_Screen_Buffer::s_setSpanY(uint16_t x1, uint16_t y1, uint16_t y2, uint16_t colour)
+{
+    if (y1 > y2)
+    {
+        hV_HAL_swap(y1, y2);
+    }
+    if ((x1 < v_clipX1) or (x1 > v_clipX2))
+    {
+        return;
+    }
+    y1 = hV_HAL_max(y1, v_clipY1);
+    y2 = hV_HAL_min(y2, v_clipY2);
 
-    int16_t dx1 = abs(wx2 - wx1);
-    int16_t dy1 = abs(wy2 - wy1);
+    for (uint16_t y = y1; y <= y2; y++)
+    {
+        s_setPoint(x1, y, colour);
+    }
+}
 
-    int16_t dx2 = abs(wx3 - wx1);
-    int16_t dy2 = abs(wy3 - wy1);
+void hV_Screen_Buffer::drawBitmap(uint16_t x0, uint16_t y0, const uint8_t * bitmap, uint16_t width, uint16_t height,
+                                  uint16_t colour, uint16_t backColour, bool flagTransparent)
+{
+    uint16_t palette[2] = { backColour, colour };
 
-    int16_t signx1 = (wx2 >= wx1) ? +1 : -1;
-    int16_t signx2 = (wx3 >= wx1) ? +1 : -1;
+    if (v_listRecord)
+    {
+        s_listBitmap(x0, y0, bitmap, width, height, BITMAP_1BPP, palette, flagTransparent, 0);
+        return;
+    }
 
-    int16_t signy1 = (wy2 >= wy1) ? +1 : -1;
-    int16_t signy2 = (wy3 >= wy1) ? +1 : -1;
+    s_setBitmap(x0, y0, bitmap, width, height, BITMAP_1BPP, palette, flagTransparent, 0);
+}
 
-    if (dy1 > dx1)
+void hV_Screen_Buffer::drawBitmap(uint16_t x0, uint16_t y0, const uint8_t * bitmap, uint16_t width, uint16_t height,
+                                  const uint16_t * palette, uint8_t transparentIndex)
+{
+    if (v_listRecord)
     {
-        hV_HAL_swap(dx1, dy1); // swap values
-        changed1 = true;
+        s_listBitmap(x0, y0, bitmap, width, height, BITMAP_2BPP, palette, (transparentIndex != BITMAP_OPAQUE), transparentIndex);
+        return;
     }
 
-    if (dy2 > dx2)
+    s_setBitmap(x0, y0, bitmap, width, height, BITMAP_2BPP, palette, (transparentIndex != BITMAP_OPAQUE), transparentIndex);
+}
+
+void hV_Screen_Buffer::drawBitmap(uint16_t x0, uint16_t y0, const uint16_t * bitmap, uint16_t width, uint16_t height,
+                                  bool flagTransparent, uint16_t transparentColour)
+{
+    if (v_listRecord)
     {
-        hV_HAL_swap(dx2, dy2); // swap values
-        changed2 = true;
+        s_listBitmap(x0, y0, (const uint8_t *)bitmap, width, height, BITMAP_RGB565, 0, flagTransparent, transparentColour);
+        return;
     }
 
-    int16_t e1 = 2 * dy1 - dx1;
-    int16_t e2 = 2 * dy2 - dx2;
+    s_setBitmap(x0, y0, (const uint8_t *)bitmap, width, height, BITMAP_RGB565, 0, flagTransparent, transparentColour);
+}
 
-    for (int i = 0; i <= dx1; i++)
+void hV_Screen_Buffer::s_setBitmap(uint16_t x0, uint16_t y0, const uint8_t * bitmap, uint16_t width, uint16_t height,
+                                   uint8_t format, const uint16_t * palette, bool flagTransparent, uint16_t transparent)
+{
+    if ((x0 >= screenSizeX()) or (y0 >= screenSizeY()))
     {
-        line(wx4, wy4, wx5, wy5, colour);
+        return;
+    }
+
+    // Row stride from the whole bitmap, loops limited to the screen
+    uint32_t bytesRow = ((uint32_t)width * format + 7) >> 3;
+    uint16_t columns = hV_HAL_min(width, (uint16_t)(screenSizeX() - x0));
+    uint16_t rows = hV_HAL_min(height, (uint16_t)(screenSizeY() - y0));
+    uint16_t colour;
 
-        while (e1 >= 0)
+    for (uint16_t j = 0; j < rows; j++)
+    {
+        const uint8_t * row = bitmap + j * bytesRow;
+        for (uint16_t i = 0; i < columns; i++)
         {
-            if (changed1)
-            {
-                wx4 += signx1;
-            }
-            else
+            if (s_getBitmapColour(row, i, format, palette, flagTransparent, transparent, colour))
             {
-                wy4 += signy1;
+                s_setPoint(x0 + i, y0 + j, colour);
             }
-            e1 = e1 - 2 * dx1;
         }
+    }
+}
 
-        if (changed1)
-        {
-            wy4 += signy1;
-        }
-        else
-        {
-            wx4 += signx1;
-        }
+bool hV_Screen_Buffer::s_getBitmapColour(const uint8_t * row, uint16_t index, uint8_t format, const uint16_t * palette, bool flagTransparent, uint16_t transparent, uint16_t & colour)
+{
+    uint16_t value;
 
-        e1 = e1 + 2 * dy1;
+    switch (format)
+    {
+        case BITMAP_1BPP:
 
-        while (wy5 != wy4)
-        {
-            while (e2 >= 0)
-            {
-                if (changed2)
-                {
-                    wx5 += signx2;
-                }
-                else
-                {
-                    wy5 += signy2;
-                }
-                e2 = e2 - 2 * dx2;
-            }
+            value = (row[index >> 3] >> (7 - (index & 0x07))) & 0x01;
+            colour = palette[value];
+            break;
 
-            if (changed2)
-            {
-                wy5 += signy2;
-            }
-            else
-            {
-                wx5 += signx2;
-            }
+        case BITMAP_2BPP:
 
-            e2 = e2 + 2 * dy2;
-        }
+            value = (row[index >> 2] >> (6 - 2 * (index & 0x03))) & 0x03;
+            colour = palette[value];
+            break;
+
+        default: // BITMAP_RGB565
+
+            value = ((const uint16_t *)row)[index];
+            colour = value;
+            break;
     }
+
+    return ((flagTransparent == false) or (value != transparent));
 }
 
-void hV_Screen_Buffer::triangle(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2, uint16_t x3, uint16_t y3, uint16_t colour)
+void hV_Screen_Buffer::dRectangle(uint16_t x0, uint16_t y0, uint16_t dx, uint16_t dy, uint16_t colour)
 {
-    if ((x1 == x2) and (y1 == y2))
+    if ((dx == 0) or (dy == 0))
     {
-        line(x3, y3, x1, y1, colour);
+        return;
     }
-    else if ((x1 == x3) and (y1 == y3))
+
+    rectangle(x0, y0, x0 + dx - 1, y0 + dy - 1, colour);
+}
+
+void hV_Screen_Buffer::s_polygonArea(const uint16_t * x, const uint16_t * y, uint8_t number, uint16_t colour, uint8_t rule)
+{
+    // Scratch kept between calls, only grown for a polygon with more points
+    if (number > v_polygonSize)
     {
-        line(x2, y2, x3, y3, colour);
+        delete[] v_polygonEdges;
+        delete[] v_polygonActive;
+        delete[] v_polygonBuffer;
+        v_polygonEdges = new (std::nothrow) polygonEdge_s[number];
+        v_polygonActive = new (std::nothrow) uint8_t[number];
+        v_polygonBuffer = new (std::nothrow) uint32_t[3 * number];
+        v_polygonSize = number;
+        if ((v_polygonEdges == 0) or (v_polygonActive == 0) or (v_polygonBuffer == 0))
+        {
+            delete[] v_polygonEdges;
+            delete[] v_polygonActive;
+            delete[] v_polygonBuffer;
+            v_polygonEdges = 0; // nullptr
+            v_polygonActive = 0; // nullptr
+            v_polygonBuffer = 0; // nullptr
+            v_polygonSize = 0;
+            hV_HAL_log(LEVEL_ERROR, "Polygon edges not created");
+            return;
+        }
     }
-    else if ((x2 == x3) and (y2 == y3))
+    polygonEdge_s * edges = v_polygonEdges;
+    uint8_t * active = v_polygonActive;
+    uint32_t * buffer = v_polygonBuffer;
+    uint32_t * crossings = buffer; // (x-axis + 0x8000) << 8 | edge, up to number
+    uint32_t * spans = buffer + number; // (first pixel + 0x8000) << 16 | (last pixel + 0x8000), up to 2 * number
+
+    // Edge table sorted by first row, coordinates above 0x7fff negative
+    uint8_t count = 0;
+    int32_t yMin = 0x7fff;
+    int32_t yMax = -0x8000;
+    for (uint8_t i = 0; i < number; i++)
     {
-        line(x1, y1, x2, y2, colour);
+        uint8_t j = (i + 1 < number) ? i + 1 : 0;
+        int32_t x1 = (int16_t)x[i];
+        int32_t y1 = (int16_t)y[i];
+        int32_t x2 = (int16_t)x[j];
+        int32_t y2 = (int16_t)y[j];
+
+        polygonEdge_s edge;
+        edge.direction = (y2 > y1) ? 1 : ((y2 < y1) ? -1 : 0);
+        if (y1 > y2)
+        {
+            hV_HAL_swap(x1, x2);
+            hV_HAL_swap(y1, y2);
+        }
+        edge.yTop = y1;
+        edge.yBottom = y2;
+
+        if (edge.direction == 0)
+        {
+            edge.x = hV_HAL_min(x1, x2);
+            edge.xTop = hV_HAL_max(x1, x2);
+        }
+        else
+        {
+            // Step per half row as floor quotient and remainder
+            edge.denominator = 2 * (y2 - y1);
+            edge.step = (x2 - x1) / edge.denominator;
+            edge.stepRemainder = (x2 - x1) % edge.denominator;
+            if (edge.stepRemainder < 0)
+            {
+                edge.step -= 1;
+                edge.stepRemainder += edge.denominator;
+            }
+            edge.x = x1;
+            edge.xTop = x1;
+            edge.remainder = y2 - y1; // half of denominator, rounded to nearest
+        }
+
+        uint8_t k = count;
+        while ((k > 0) and (edges[k - 1].yTop > edge.yTop))
+        {
+            edges[k] = edges[k - 1];
+            k -= 1;
+        }
+        edges[k] = edge;
+        count += 1;
+
+        yMin = hV_HAL_min(yMin, y1);
+        yMax = hV_HAL_max(yMax, y2);
     }
-    else if (v_penSolid)
-    {
-        bool b = true;
 
-        // Graham Scan + Andrew's Monotone Chain Algorithm
-        // Sort by ascending y
-        while (b)
+    // Rows clipped once
+    yMin = hV_HAL_max(yMin, (int32_t)v_clipY1);
+    yMax = hV_HAL_min(yMax, (int32_t)v_clipY2);
+
+    uint8_t next = 0;
+    uint8_t actives = 0;
+    for (int32_t row = yMin; row <= yMax; row++)
+    {
+        // Edges starting on the row, or above the screen on the first row
+        while ((next < count) and (edges[next].yTop <= row))
         {
-            b = false;
-            if ((b == false) and (y1 > y2))
+            polygonEdge_s & edge = edges[next];
+            if (edge.yBottom < row)
             {
-                hV_HAL_swap(x1, x2);
-                hV_HAL_swap(y1, y2);
-                b = true;
+                next += 1;
+                continue; // edge above the screen
             }
-            if ((b == false) and (y2 > y3))
+
+            if ((edge.direction != 0) and (edge.yTop < row))
             {
-                hV_HAL_swap(x3, x2);
-                hV_HAL_swap(y3, y2);
-                b = true;
+                // Moved to the top of the row at once, then to the centre
+                int64_t t = 2 * (int64_t)(row - edge.yTop) - 1;
+                int64_t fraction = edge.remainder + t * edge.stepRemainder;
+                edge.x += (int32_t)(t * edge.step + fraction / edge.denominator);
+                edge.remainder = (int32_t)(fraction % edge.denominator);
+                edge.xTop = edge.x;
+
+                edge.x += edge.step;
+                edge.remainder += edge.stepRemainder;
+                if (edge.remainder >= edge.denominator)
+                {
+                    edge.x += 1;
+                    edge.remainder -= edge.denominator;
+                }
             }
+
+            active[actives] = next;
+            actives += 1;
+            next += 1;
         }
 
-        if (y2 == y3)
+        // Pixels of the active edges, crossings of the centre of the row
+        uint16_t numberCrossings = 0;
+        uint16_t numberSpans = 0;
+        uint8_t k = 0;
+        while (k < actives)
         {
-            s_triangleArea(x1, y1, x2, y2, x3, y3, colour);
+            polygonEdge_s & edge = edges[active[k]];
+
+            if (edge.direction == 0)
+            {
+                edge.xLeft = edge.x;
+                edge.xRight = edge.xTop;
+            }
+            else
+            {
+                int32_t xTop = (row == edge.yTop) ? edge.x : edge.xTop;
+                int32_t xBottom = edge.x;
+
+                if (row < edge.yBottom)
+                {
+                    crossings[numberCrossings] = ((uint32_t)(edge.x + 0x8000) << 8) | active[k];
+                    numberCrossings += 1;
+
+                    // Two half rows, bottom of this row then centre of next row
+                    for (uint8_t half = 0; half < 2; half++)
+                    {
+                        edge.x += edge.step;
+                        edge.remainder += edge.stepRemainder;
+                        if (edge.remainder >= edge.denominator)
+                        {
+                            edge.x += 1;
+                            edge.remainder -= edge.denominator;
+                        }
+                        if (half == 0)
+                        {
+                            xBottom = edge.x;
+                            edge.xTop = edge.x;
+                        }
+                    }
+                }
+                edge.xLeft = hV_HAL_min(xTop, xBottom);
+                edge.xRight = hV_HAL_max(xTop, xBottom);
+            }
+
+            spans[numberSpans] = ((uint32_t)(edge.xLeft + 0x8000) << 16) | (edge.xRight + 0x8000);
+            numberSpans += 1;
+
+            // Edges ending on the row
+            if (row >= edge.yBottom)
+            {
+                actives -= 1;
+                active[k] = active[actives];
+            }
+            else
+            {
+                k += 1;
+            }
         }
-        else if (y1 == y2)
+
+        // Inside between crossings, according to rule
+        for (uint16_t i = 1; i < numberCrossings; i++)
         {
-            s_triangleArea(x3, y3, x1, y1, x2, y2, colour);
+            uint32_t item = crossings[i];
+            uint16_t j = i;
+            while ((j > 0) and (crossings[j - 1] > item))
+            {
+                crossings[j] = crossings[j - 1];
+                j -= 1;
+            }
+            crossings[j] = item;
         }
-        else
+
+        int16_t winding = 0;
+        int32_t xStart = 0;
+        int32_t xStartRight = 0;
+        for (uint16_t i = 0; i < numberCrossings; i++)
         {
-            uint16_t x4 = (uint16_t)((int32_t)x1 + (y2 - y1) * (x3 - x1) / (y3 - y1));
-            uint16_t y4 = y2;
+            polygonEdge_s & edge = edges[crossings[i] & 0xff];
+            bool flagBefore = (rule == FILL_NON_ZERO) ? (winding != 0) : ((i & 0x01) == 1);
+            winding += edge.direction;
+            bool flagAfter = (rule == FILL_NON_ZERO) ? (winding != 0) : ((i & 0x01) == 0);
 
-            s_triangleArea(x1, y1, x2, y2, x4, y4, colour);
+            if ((flagBefore == false) and flagAfter)
+            {
+                xStart = edge.xLeft;
+                xStartRight = edge.xRight;
+            }
+            else if (flagBefore and (flagAfter == false))
+            {
+                spans[numberSpans] = ((uint32_t)(hV_HAL_min(xStart, edge.xLeft) + 0x8000) << 16) | (hV_HAL_max(xStartRight, edge.xRight) + 0x8000);
+                numberSpans += 1;
+            }
+        }
 
-#if defined(ESP8266)
-            hV_HAL_delayMilliseconds(1);
-#else
-            hV_HAL_delayMicroseconds(1000); // delay(1);
-#endif // ESP8266
+        // Spans merged, each pixel written once
+        for (uint16_t i = 1; i < numberSpans; i++)
+        {
+            uint32_t item = spans[i];
+            uint16_t j = i;
+            while ((j > 0) and (spans[j - 1] > item))
+            {
+                spans[j] = spans[j - 1];
+                j -= 1;
+            }
+            spans[j] = item;
+        }
 
-            hV_HAL_delayMicroseconds(1000); // delay(1);
-            s_triangleArea(x3, y3, x2, y2, x4, y4, colour);
+        uint16_t numberMerged = 0;
+        for (uint16_t i = 0; i < numberSpans; i++)
+        {
+            uint32_t xFirst = spans[i] >> 16;
+            uint32_t xLast = spans[i] & 0xffff;
+            if (numberMerged > 0)
+            {
+                uint32_t xPrevious = spans[numberMerged - 1] & 0xffff;
+                if (xFirst <= xPrevious + 1)
+                {
+                    spans[numberMerged - 1] = (spans[numberMerged - 1] & 0xffff0000) | hV_HAL_max(xPrevious, xLast);
+                    continue;
+                }
+            }
+            spans[numberMerged] = spans[i];
+            numberMerged += 1;
+        }
 
-#if defined(ESP8266)
-            hV_HAL_delayMilliseconds(1);
-#else
-            hV_HAL_delayMicroseconds(1000); // delay(1);
-#endif // ESP8266
+        // Spans clipped on the left, s_setSpanX() clips on the right
+        for (uint16_t i = 0; i < numberMerged; i++)
+        {
+            int32_t xFirst = (int32_t)(spans[i] >> 16) - 0x8000;
+            int32_t xLast = (int32_t)(spans[i] & 0xffff) - 0x8000;
+            if (xLast >= v_clipX1)
+            {
+                s_setSpanX(hV_HAL_max(xFirst, (int32_t)v_clipX1), xLast, row, colour);
+            }
         }
     }
+}
+
+void hV_Screen_Buffer::triangle(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2, uint16_t x3, uint16_t y3, uint16_t colour)
+{
+    if (v_listRecord)
+    {
+        uint16_t values[] = { x1, y1, x2, y2, x3, y3, colour };
+        s_listRecord(LIST_TRIANGLE,
+                     hV_HAL_min(hV_HAL_min((int16_t)x1, (int16_t)x2), (int16_t)x3), hV_HAL_min(hV_HAL_min((int16_t)y1, (int16_t)y2), (int16_t)y3),
+                     hV_HAL_max(hV_HAL_max((int16_t)x1, (int16_t)x2), (int16_t)x3), hV_HAL_max(hV_HAL_max((int16_t)y1, (int16_t)y2), (int16_t)y3),
+                     values, 7);
+        return;
+    }
+
+    if ((x1 == x2) and (y1 == y2))
+    {
+        line(x3, y3, x1, y1, colour);
+    }
+    else if ((x1 == x3) and (y1 == y3))
+    {
+        line(x2, y2, x3, y3, colour);
+    }
+    else if ((x2 == x3) and (y2 == y3))
+    {
+        line(x1, y1, x2, y2, colour);
+    }
+    else if (v_penSolid)
+    {
+        uint16_t x[3] = { x1, x2, x3 };
+        uint16_t y[3] = { y1, y2, y3 };
+
+        s_polygonArea(x, y, 3, colour, FILL_EVEN_ODD);
+    }
     else
     {
         line(x1, y1, x2, y2, colour);
@@ -527,6 +1131,63 @@ void hV_Screen_Buffer::triangle(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t
     }
 }
 
+void hV_Screen_Buffer::polygon(const uint16_t * x, const uint16_t * y, uint8_t number, uint16_t colour, uint8_t rule)
+{
+    if (number == 0)
+    {
+        return;
+    }
+    else if (v_listRecord)
+    {
+        int32_t x1 = (int16_t)x[0];
+        int32_t y1 = (int16_t)y[0];
+        int32_t x2 = x1;
+        int32_t y2 = y1;
+        for (uint8_t i = 1; i < number; i++)
+        {
+            x1 = hV_HAL_min(x1, (int32_t)(int16_t)x[i]);
+            y1 = hV_HAL_min(y1, (int32_t)(int16_t)y[i]);
+            x2 = hV_HAL_max(x2, (int32_t)(int16_t)x[i]);
+            y2 = hV_HAL_max(y2, (int32_t)(int16_t)y[i]);
+        }
+
+        s_listBegin(LIST_POLYGON, x1, y1, x2, y2);
+        s_listAppend(colour);
+        s_listAppend(rule);
+        s_listAppend(number);
+        for (uint8_t i = 0; i < number; i++)
+        {
+            s_listAppend(x[i]);
+        }
+        for (uint8_t i = 0; i < number; i++)
+        {
+            s_listAppend(y[i]);
+        }
+        s_listEnd();
+        return;
+    }
+    else if (number == 1)
+    {
+        point(x[0], y[0], colour);
+    }
+    else if (number == 2)
+    {
+        line(x[0], y[0], x[1], y[1], colour);
+    }
+    else if (v_penSolid)
+    {
+        s_polygonArea(x, y, number, colour, rule);
+    }
+    else
+    {
+        for (uint8_t i = 0; i < number; i++)
+        {
+            uint8_t j = (i + 1 < number) ? i + 1 : 0;
+            line(x[i], y[i], x[j], y[j], colour);
+        }
+    }
+}
+
 //
 // === Touch section
 //
@@ -632,6 +1293,11 @@ void hV_Screen_Buffer::setFontSolid(bool flag)
     f_setFontSolid(flag);
 }
 
+bool hV_Screen_Buffer::getFontSolid()
+{
+    return f_fontSolid;
+}
+
 uint8_t hV_Screen_Buffer::addFont(font_s fontName)
 {
     return f_addFont(fontName);
@@ -661,20 +1327,17 @@ uint16_t hV_Screen_Buffer::characterSizeX(STRING_CONST_TYPE character)
     }
     else
     {
-        uint16_t buffer2[2] = {0};
-        uint16_t _size16 = 0;
-
 #if (STRING_MODE == USE_STRING_OBJECT)
 
-        _size16 = utf8to16(character.c_str(), buffer2, 2);
+        TextIterator iterator(character.c_str());
 
 #elif (STRING_MODE == USE_CHAR_ARRAY)
 
-        _size16 = utf8to16(character, buffer2, 2);
+        TextIterator iterator(character);
 
 #endif // STRING_MODE
 
-        result = characterSizeX(buffer2[0]);
+        result = characterSizeX(iterator.next());
     }
 
     return result;
@@ -731,9 +1394,9 @@ void hV_Screen_Buffer::setFontSpaceY(uint8_t number)
     f_setFontSpaceY(number);
 }
 
-uint8_t hV_Screen_Buffer::s_getCharacter(uint8_t character, uint8_t index)
+uint8_t hV_Screen_Buffer::s_getCharacter(uint16_t glyph, uint8_t index)
 {
-    return f_getCharacter(character, index);
+    return f_getCharacter(glyph, index);
 }
 
 void hV_Screen_Buffer::gText(uint16_t x0, uint16_t y0,
@@ -741,15 +1404,8 @@ void hV_Screen_Buffer::gText(uint16_t x0, uint16_t y0,
                              uint16_t textColour,
                              uint16_t backColour)
 {
-    uint16_t _buffer16[BUFFER_LENGTH] = {0};
-    uint16_t _size16 = utf8to16(text8.c_str(), _buffer16);
-
-    if (_size16 == 0)
-    {
-        return;
-    }
-
-    gText(x0, y0, _buffer16, textColour, backColour);
+    TextIterator iterator(text8.c_str());
+    s_setText(x0, y0, iterator, textColour, backColour);
 }
 
 void hV_Screen_Buffer::gText(uint16_t x0, uint16_t y0,
@@ -757,383 +1413,793 @@ void hV_Screen_Buffer::gText(uint16_t x0, uint16_t y0,
                              uint16_t textColour,
                              uint16_t backColour)
 {
-    uint16_t _size16 = 0;
-    while (text16[++_size16] != 0x0000);
-    _size16 = (text16[0] == 0x000) ? 0 : _size16;
+    TextIterator iterator(text16);
+    s_setText(x0, y0, iterator, textColour, backColour);
+}
 
-    if (_size16 == 0)
+void hV_Screen_Buffer::s_setText(uint16_t x0, uint16_t y0, TextIterator & iterator, uint16_t textColour, uint16_t backColour)
+{
+    if (v_listRecord)
     {
+        s_listBegin(LIST_TEXT, x0, y0, x0, y0);
+        s_listAppend(x0);
+        s_listAppend(y0);
+        s_listAppend(textColour);
+        s_listAppend(backColour);
+        uint32_t width = s_listText(iterator);
+        s_listBox(x0, y0, (int32_t)x0 + width - 1, (int32_t)y0 + f_font.height - 1);
+        s_listEnd();
         return;
     }
 
 #if (FONT_MODE == USE_FONT_TERMINAL)
 
-    uint8_t character8;
-    uint8_t line, line1, line2; // , line3;
-    uint16_t x, y;
-    uint8_t i, j, k;
+    uint16_t glyph;
+    uint16_t character;
+    uint16_t x = x0;
 
-#if (MAX_FONT_SIZE > 0)
+    // Characters decoded and drawn in one pass
+    while ((character = iterator.next()) != 0x0000)
+    {
+        glyph = f_getGlyph(character);
+        s_setCharacter(x, y0, glyph, textColour, backColour);
+        x += f_getWidth(glyph) + f_fontSpaceX;
+    }
+
+#endif // FONT_MODE
+}
+
+void hV_Screen_Buffer::s_setCharacter(uint16_t x0, uint16_t y0, uint16_t glyph, uint16_t textColour, uint16_t backColour)
+{
+#if (FONT_MODE == USE_FONT_TERMINAL)
 
-    if (f_fontIndex == 0)
+    uint8_t width = f_getWidth(glyph);
+
+    for (uint8_t i = 0; i < width; i++)
     {
-        for (k = 0; k < _size16; k++)
-        {
-            x = x0 + (6 + f_fontSpaceX) * k;
-            y = y0;
-            character8 = (text16[k] == 0x20ac) ? 0x80 - ' ' : (text16[k] & 0xff) - ' ';
+        uint32_t column = s_getColumn(glyph, i);
 
-            for (i = 0; i < 6; i++)
+        for (uint8_t j = 0; j < f_font.height; j++)
+        {
+            if (bitRead(column, j))
             {
-                line = f_getCharacter(character8, i);
-
-                for (j = 0; j < 8; j++)
-                {
-                    if (bitRead(line, j))
-                    {
-                        point(x + i, y + j, textColour);
-                    }
-                    else if (f_fontSolid)
-                    {
-                        point(x + i, y + j, backColour);
-                    }
-                }
+                point(x0 + i, y0 + j, textColour);
+            }
+            else if (f_fontSolid)
+            {
+                point(x0 + i, y0 + j, backColour);
             }
         }
     }
 
-#if (MAX_FONT_SIZE > 1)
+#endif // FONT_MODE
+}
+
+uint16_t hV_Screen_Buffer::textBox(uint16_t x0, uint16_t y0, uint16_t dx, uint16_t dy,
+                                   STRING_CONST_TYPE text8,
+                                   uint8_t alignment, uint8_t overflow,
+                                   uint16_t textColour, uint16_t backColour)
+{
+    TextIterator iterator(text8.c_str());
+    return s_textBox(x0, y0, dx, dy, iterator, alignment, overflow, textColour, backColour);
+}
+
+uint16_t hV_Screen_Buffer::s_textBox(uint16_t x0, uint16_t y0, uint16_t dx, uint16_t dy, TextIterator & iterator,
+                                     uint8_t alignment, uint8_t overflow, uint16_t textColour, uint16_t backColour)
+{
+    uint16_t count = 0;
 
-    else if (f_fontIndex == 1)
+    if (v_listRecord)
     {
-        for (k = 0; k < _size16; k++)
-        {
-            x = x0 + (8 + f_fontSpaceX) * k;
-            y = y0;
-            character8 = (text16[k] == 0x20ac) ? 0x80 - ' ' : (text16[k] & 0xff) - ' ';
+        s_listBegin(LIST_TEXT_BOX, x0, y0, (int32_t)x0 + dx - 1, (int32_t)y0 + dy - 1);
+        s_listAppend(x0);
+        s_listAppend(y0);
+        s_listAppend(dx);
+        s_listAppend(dy);
+        s_listAppend(alignment | (overflow << 8));
+        s_listAppend(textColour);
+        s_listAppend(backColour);
+        s_listText(iterator);
+        s_listEnd();
+        return count;
+    }
 
-            for (i = 0; i < 8; i++)
-            {
-                line = f_getCharacter(character8, 2 * i);
-                line1 = f_getCharacter(character8, 2 * i + 1);
+    if ((dx == 0) or (dy == 0))
+    {
+        return count;
+    }
 
-                for (j = 0; j < 8; j++)
-                {
-                    if (bitRead(line, j))
-                    {
-                        point(x + i, y + j, textColour);
-                    }
-                    else if (f_fontSolid)
-                    {
-                        point(x + i, y + j, backColour);
-                    }
-                    if (bitRead(line1, j))
-                    {
-                        point(x + i, y + 8 + j, textColour);
-                    }
-                    else if ((f_fontSolid) and (j < 4))
-                    {
-                        point(x + i, y + 8 + j, backColour);
-                    }
-                }
-            }
-        }
+#if (FONT_MODE == USE_FONT_TERMINAL)
+
+    uint16_t x2 = x0 + dx - 1;
+    uint16_t y2 = y0 + dy - 1;
+    uint16_t height = f_font.height;
+    uint16_t advanceY = height + f_fontSpaceY;
+    uint16_t advanceDot = f_getWidth(f_getGlyph('.')) + f_fontSpaceX;
+
+    // Capacity of the box, no space after last character and last line
+    uint16_t budget = dx + f_fontSpaceX;
+    uint16_t rows = (dy + f_fontSpaceY) / advanceY;
+    if (overflow != OVERFLOW_WRAP)
+    {
+        rows = hV_HAL_min(rows, (uint16_t)1);
+    }
+
+    // One line centred vertically, wrapped lines from the top
+    uint16_t y = y0;
+    uint16_t yFill = y0; // first row of pixels not yet filled
+    if (overflow != OVERFLOW_WRAP)
+    {
+        y += (dy - height) / 2;
     }
 
-#if (MAX_FONT_SIZE > 2)
+    // Cells of characters with background
+    bool flagSolid = f_fontSolid;
+    f_fontSolid = true;
 
-    else if (f_fontIndex == 2)
+    uint16_t character;
+    uint16_t glyph;
+    uint8_t width;
+
+    for (uint16_t row = 0; row < rows; row += 1)
     {
-        for (k = 0; k < _size16; k++)
+        // Look-ahead on a copy of the iterator, up to one character beyond the line
+        TextIterator scan = iterator;
+        uint16_t length = 0;
+        uint16_t total = 0; // pixels, with space after each character
+        uint16_t lengthWord = 0; // up to the last space
+        uint16_t totalWord = 0;
+        uint16_t lengthDots = 0; // up to the last character followed by three dots
+        uint16_t totalDots = 0;
+        uint8_t skip = 0; // characters not drawn after the line
+        bool flagMore = false; // characters beyond the line
+
+        while ((character = scan.next()) != 0x0000)
         {
-            x = x0 + (12 + f_fontSpaceX) * k;
-            y = y0;
-            character8 = (text16[k] == 0x20ac) ? 0x80 - ' ' : (text16[k] & 0xff) - ' ';
+            if ((overflow == OVERFLOW_WRAP) and (character == '\n'))
+            {
+                skip = 1;
+                break;
+            }
 
-            for (i = 0; i < 12; i++)
+            uint16_t advance = f_getWidth(f_getGlyph(character)) + f_fontSpaceX;
+            if (total + advance > budget)
             {
-                line = f_getCharacter(character8, 2 * i);
-                line1 = f_getCharacter(character8, 2 * i + 1);
+                flagMore = true;
+                break;
+            }
+            if (character == ' ')
+            {
+                lengthWord = length;
+                totalWord = total;
+            }
+            length += 1;
+            total += advance;
+            if (total + 3 * advanceDot <= budget)
+            {
+                lengthDots = length;
+                totalDots = total;
+            }
+        }
 
-                for (j = 0; j < 8; j++)
-                {
-                    if (bitRead(line, j))
-                    {
-                        point(x + i, y + j, textColour);
-                    }
-                    else if (f_fontSolid)
-                    {
-                        point(x + i, y + j, backColour);
-                    }
-                    if (bitRead(line1, j))
+        // Cut the line
+        uint8_t dots = 0;
+        if (flagMore)
+        {
+            switch (overflow)
+            {
+                case OVERFLOW_ELLIPSIS:
+
+                    length = lengthDots;
+                    total = totalDots;
+                    dots = hV_HAL_min((uint16_t)((budget - total) / advanceDot), (uint16_t)3);
+                    total += dots * advanceDot;
+                    break;
+
+                case OVERFLOW_WRAP:
+
+                    if (character == ' ')
                     {
-                        point(x + i, y + 8 + j, textColour);
+                        skip = 1; // space after the line
                     }
-                    else if (f_fontSolid)
+                    else if (lengthWord > 0)
                     {
-                        point(x + i, y + 8 + j, backColour);
+                        length = lengthWord;
+                        total = totalWord;
+                        skip = 1; // last space of the line
                     }
-                }
+                    break;
+
+                default:
+
+                    break;
             }
         }
-    }
 
-#if (MAX_FONT_SIZE > 3)
+        // Align the line
+        uint16_t widthLine = (total > 0) ? total - f_fontSpaceX : 0;
+        uint16_t x = x0;
+        switch (alignment)
+        {
+            case ALIGN_CENTER:
 
-    else if (f_fontIndex == 3)
-    {
-        for (k = 0; k < _size16; k++)
+                x += (dx - widthLine) / 2;
+                break;
+
+            case ALIGN_RIGHT:
+
+                x += dx - widthLine;
+                break;
+
+            default:
+
+                break;
+        }
+
+        // Background above, on the left and on the right of the line
+        if (y > yFill)
         {
-            x = x0 + (16 + f_fontSpaceX) * k;
-            y = y0;
-            character8 = (text16[k] == 0x20ac) ? 0x80 - ' ' : (text16[k] & 0xff) - ' ';
+            s_setRectangle(x0, yFill, x2, y - 1, backColour);
+        }
+        if (x > x0)
+        {
+            s_setRectangle(x0, y, x - 1, y + height - 1, backColour);
+        }
+        if (x + widthLine <= x2)
+        {
+            s_setRectangle(x + widthLine, y, x2, y + height - 1, backColour);
+        }
+
+        // Draw the line, characters then dots
+        for (uint16_t k = 0; k < length + dots; k += 1)
+        {
+            character = (k < length) ? iterator.next() : '.';
+            glyph = f_getGlyph(character);
+            width = f_getWidth(glyph);
+            s_setCharacter(x, y, glyph, textColour, backColour);
 
-            for (i = 0; i < 16; i++)
+            // Background between characters
+            if ((f_fontSpaceX > 0) and (k + 1 < length + dots))
             {
-                line = f_getCharacter(character8, 3 * i);
-                line1 = f_getCharacter(character8, 3 * i + 1);
-                line2 = f_getCharacter(character8, 3 * i + 2);
-                for (j = 0; j < 8; j++)
-                {
-                    if (bitRead(line, j))
-                    {
-                        point(x + i, y + j, textColour);
-                    }
-                    else if (f_fontSolid)
-                    {
-                        point(x + i, y + j, backColour);
-                    }
-                    if (bitRead(line1, j))
-                    {
-                        point(x + i, y + 8 + j, textColour);
-                    }
-                    else if (f_fontSolid)
-                    {
-                        point(x + i, y + 8 + j, backColour);
-                    }
-                    if (bitRead(line2, j))
-                    {
-                        point(x + i, y + 16 + j, textColour);
-                    }
-                    else if (f_fontSolid)
-                    {
-                        point(x + i, y + 16 + j, backColour);
-                    }
-                }
+                s_setRectangle(x + width, y, x + width + f_fontSpaceX - 1, y + height - 1, backColour);
             }
+            x += width + f_fontSpaceX;
         }
+        count += length + dots;
+
+        for (uint8_t k = 0; k < skip; k += 1)
+        {
+            iterator.next();
+        }
+        yFill = y + height;
+        y += advanceY;
+
+        // End of text
+        scan = iterator;
+        if (scan.next() == 0x0000)
+        {
+            break;
+        }
+    }
+
+    // Background below the last line
+    if (yFill <= y2)
+    {
+        s_setRectangle(x0, yFill, x2, y2, backColour);
     }
-#endif // end MAX_FONT_SIZE > 3
-#endif // end MAX_FONT_SIZE > 2
-#endif // end MAX_FONT_SIZE > 1
-#endif // end MAX_FONT_SIZE > 0
+
+    f_fontSolid = flagSolid;
 
 #endif // FONT_MODE
+
+    return count;
 }
 
-void hV_Screen_Buffer::gTextLarge(uint16_t x0, uint16_t y0,
-                                  STRING_CONST_TYPE text8,
-                                  uint16_t textColour,
-                                  uint16_t backColour)
+uint32_t hV_Screen_Buffer::s_getColumn(uint16_t glyph, uint8_t index)
 {
-    uint16_t _buffer16[BUFFER_LENGTH] = {0};
-    uint16_t _size16 = 0;
+    uint32_t column = 0;
+
+#if (FONT_MODE == USE_FONT_TERMINAL)
 
-    _size16 = utf8to16(text8.c_str(), _buffer16);
+    // Columns of 1 to 3 bytes, bit j of byte b for row 8 * b + j
+    uint8_t bytes = (f_font.height + 7) >> 3;
 
-    if (_size16 == 0)
+    for (uint8_t b = 0; b < bytes; b++)
     {
-        return;
+        column |= (uint32_t)f_getCharacter(glyph, bytes * index + b) << (8 * b);
     }
+    if (f_font.height < 32)
+    {
+        column &= ((uint32_t)1 << f_font.height) - 1;
+    }
+
+#endif // FONT_MODE
 
-    gTextLarge(x0, y0, _buffer16, textColour, backColour);
+    return column;
+}
+
+void hV_Screen_Buffer::gTextLarge(uint16_t x0, uint16_t y0,
+                                  STRING_CONST_TYPE text8,
+                                  uint16_t textColour,
+                                  uint16_t backColour,
+                                  uint8_t scaleX, uint8_t scaleY)
+{
+    TextIterator iterator(text8.c_str());
+    s_setTextLarge(x0, y0, iterator, textColour, backColour, scaleX, scaleY);
 }
 
 void hV_Screen_Buffer::gTextLarge(uint16_t x0, uint16_t y0,
                                   STRING16_CONST_TYPE text16,
                                   uint16_t textColour,
-                                  uint16_t backColour)
+                                  uint16_t backColour,
+                                  uint8_t scaleX, uint8_t scaleY)
 {
-    uint16_t _size16 = 0;
-    while (text16[++_size16] != 0x0000);
-    if (_size16 == 0)
-    {
-        return;
-    }
+    TextIterator iterator(text16);
+    s_setTextLarge(x0, y0, iterator, textColour, backColour, scaleX, scaleY);
+}
 
+void hV_Screen_Buffer::s_setTextLarge(uint16_t x0, uint16_t y0, TextIterator & iterator,
+                                      uint16_t textColour, uint16_t backColour,
+                                      uint8_t scaleX, uint8_t scaleY)
+{
 #if (FONT_MODE == USE_FONT_TERMINAL)
 
-    uint8_t character8;
-    uint8_t line, line1, line2; //, line3;
-    uint16_t x, y;
-    uint8_t i, j, k;
-
-    uint8_t ix = 2;
-    uint8_t iy = 2;
+    // Scales from 2 to 8, y-axis same as x-axis by default
+    if (scaleY == 0)
+    {
+        scaleY = scaleX;
+    }
+    scaleX = hV_HAL_min(hV_HAL_max(scaleX, (uint8_t)2), (uint8_t)8);
+    scaleY = hV_HAL_min(hV_HAL_max(scaleY, (uint8_t)2), (uint8_t)8);
 
-    bool oldPenSolid = v_penSolid;
-    setPenSolid(true);
+    if (v_listRecord)
+    {
+        s_listBegin(LIST_TEXT_LARGE, x0, y0, x0, y0);
+        s_listAppend(x0);
+        s_listAppend(y0);
+        s_listAppend(textColour);
+        s_listAppend(backColour);
+        s_listAppend(scaleX | (scaleY << 8));
+        uint32_t width = s_listText(iterator) * scaleX;
+        s_listBox(x0, y0, (int32_t)x0 + width - 1, (int32_t)y0 + f_font.height * scaleY - 1);
+        s_listEnd();
+        return;
+    }
 
-#if (MAX_FONT_SIZE > 0)
+    uint16_t glyph;
+    uint16_t character;
+    uint16_t x = x0;
+    uint16_t y1;
+    uint8_t width;
+    uint8_t height = f_font.height;
 
-    if (f_fontIndex == 0)
+    // Characters decoded and drawn in one pass
+    while ((character = iterator.next()) != 0x0000)
     {
-        for (k = 0; k < _size16; k++)
+        glyph = f_getGlyph(character);
+        width = f_getWidth(glyph);
+
+        uint8_t i = 0;
+        while (i < width)
         {
-            x = x0 + (6 + f_fontSpaceX) * k * ix;
-            y = y0;
-            character8 = (text16[k] == 0x20ac) ? 0x80 - ' ' : (text16[k] & 0xff) - ' ';
+            uint32_t column = s_getColumn(glyph, i);
+
+            // Identical columns merged
+            uint8_t count = 1;
+            while ((i + count < width) and (s_getColumn(glyph, i + count) == column))
+            {
+                count += 1;
+            }
 
-            for (i = 0; i < 6; i++)
+            // Runs of identical pixels merged
+            uint8_t j = 0;
+            while (j < height)
             {
-                line = f_getCharacter(character8, i);
+                bool flagText = bitRead(column, j);
+                uint8_t run = 1;
+                while ((j + run < height) and (bitRead(column, j + run) == flagText))
+                {
+                    run += 1;
+                }
 
-                for (j = 0; j < 8; j++)
+                if (flagText or f_fontSolid)
                 {
-                    if (bitRead(line, j))
-                    {
-                        dRectangle(x + i * ix, y + j * iy, ix, iy, textColour);
-                    }
-                    else if (f_fontSolid)
-                    {
-                        dRectangle(x + i * ix, y + j * iy, ix, iy, backColour);
-                    }
+                    y1 = y0 + j * scaleY;
+                    s_setRectangle(x + i * scaleX, y1, x + (i + count) * scaleX - 1, y1 + run * scaleY - 1,
+                                   (flagText) ? textColour : backColour);
                 }
+                j += run;
             }
+            i += count;
         }
+        x += (width + f_fontSpaceX) * scaleX;
     }
 
-#if (MAX_FONT_SIZE > 1)
+#endif // FONT_MODE
+}
+//
+// === End of Font section
+//
+
+
+//
+// === Display list section
+//
+bool hV_Screen_Buffer::beginList(uint32_t size)
+{
+    uint32_t words = size >> 1;
 
-    else if (f_fontIndex == 1)
+    if (v_listImmediate)
     {
-        for (k = 0; k < _size16; k++)
-        {
-            x = x0 + (8 + f_fontSpaceX) * k * ix;
-            y = y0;
-            character8 = (text16[k] == 0x20ac) ? 0x80 - ' ' : (text16[k] & 0xff) - ' ';
+        hV_HAL_log(LEVEL_ERROR, "Display list not available");
+        return RESULT_ERROR;
+    }
 
-            for (i = 0; i < 8; i++)
-            {
-                line = f_getCharacter(character8, 2 * i);
-                line1 = f_getCharacter(character8, 2 * i + 1);
+    if (words != v_listSize)
+    {
+        deleteList();
+        if (words < LIST_HEADER)
+        {
+            hV_HAL_log(LEVEL_ERROR, "Display list too small");
+            return RESULT_ERROR;
+        }
 
-                for (j = 0; j < 8; j++)
-                {
-                    if (bitRead(line, j))
-                    {
-                        dRectangle(x + i * ix, y0 + j * iy, ix, iy, textColour);
-                    }
-                    else if (f_fontSolid)
-                    {
-                        dRectangle(x + i * ix, y0 + j * iy, ix, iy, backColour);
-                    }
-                    if (bitRead(line1, j))
-                    {
-                        dRectangle(x + i * ix, y0 + (8 + j) * iy, ix, iy, textColour);
-                    }
-                    else if ((f_fontSolid) and (j < 4))
-                    {
-                        dRectangle(x + i * ix, y0 + (8 + j) * iy, ix, iy, backColour);
-                    }
-                }
-            }
+        v_list = new (std::nothrow) uint16_t[words];
+        if (v_list == 0)
+        {
+            hV_HAL_log(LEVEL_ERROR, "Display list not created");
+            return RESULT_ERROR;
         }
+        v_listSize = words;
     }
 
-#if (MAX_FONT_SIZE > 2)
+    v_listLength = 0;
+    v_listCount = 0;
+    v_listError = false;
+    v_listOrientation = v_orientation;
+    v_listRecord = true;
+    return RESULT_SUCCESS;
+}
 
-    else if (f_fontIndex == 2)
+bool hV_Screen_Buffer::endList()
+{
+    if (v_listImmediate)
     {
-        for (k = 0; k < _size16; k++)
-        {
-            x = x0 + (12 + f_fontSpaceX) * k * ix;
-            y = y0;
-            character8 = (text16[k] == 0x20ac) ? 0x80 - ' ' : (text16[k] & 0xff) - ' ';
+        return RESULT_ERROR;
+    }
 
-            for (i = 0; i < 12; i++)
-            {
-                line = f_getCharacter(character8, 2 * i);
-                line1 = f_getCharacter(character8, 2 * i + 1);
+    v_listRecord = false;
+    return (v_listError) ? RESULT_ERROR : RESULT_SUCCESS;
+}
 
-                for (j = 0; j < 8; j++)
-                {
-                    if (bitRead(line, j))
-                    {
-                        dRectangle(x + i * ix, y0 + j * iy, ix, iy, textColour);
-                    }
-                    else if (f_fontSolid)
-                    {
-                        dRectangle(x + i * ix, y0 + j * iy, ix, iy, backColour);
-                    }
-                    if (bitRead(line1, j))
-                    {
-                        dRectangle(x + i * ix, y0 + (8 + j) * iy, ix, iy, textColour);
-                    }
-                    else if (f_fontSolid)
-                    {
-                        dRectangle(x + i * ix, y0 + (8 + j) * iy, ix, iy, backColour);
-                    }
-                }
-            }
-        }
+uint16_t hV_Screen_Buffer::replayList(uint16_t x0, uint16_t y0, uint16_t dx, uint16_t dy)
+{
+    if ((v_list == 0) or v_listRecord)
+    {
+        return 0;
     }
 
-#if (MAX_FONT_SIZE > 3)
+    // State restored after
+    uint8_t oldOrientation = v_orientation;
+    bool oldPenSolid = v_penSolid;
+    bool oldFontSolid = f_fontSolid;
+    uint8_t oldFont = f_fontIndex;
+    uint8_t oldSpaceX = f_fontSpaceX;
+    uint8_t oldSpaceY = f_fontSpaceY;
+    uint16_t oldClip[4] = { v_clipX1, v_clipY1, v_clipX2, v_clipY2 };
+    uint8_t oldClipDepth = v_clipDepth;
+
+    if (v_orientation != v_listOrientation)
+    {
+        setOrientation(v_listOrientation);
+    }
 
-    else if (f_fontIndex == 3)
+    // Region as clip rectangle, whole screen drawn as recorded
+    bool flagRegion = ((dx > 0) and (dy > 0));
+    if (flagRegion and (pushClip(x0, y0, dx, dy) == RESULT_ERROR))
     {
-        for (k = 0; k < _size16; k++)
+        return 0;
+    }
+
+    uint16_t count = 0;
+    uint32_t index = 0;
+    while (index < v_listLength)
+    {
+        const uint16_t * item = v_list + index;
+        index += item[1];
+
+        // Commands outside the clip rectangle skipped
+        if (((int16_t)item[6] < (int32_t)v_clipX1) or ((int16_t)item[4] > (int32_t)v_clipX2) or
+                ((int16_t)item[7] < (int32_t)v_clipY1) or ((int16_t)item[5] > (int32_t)v_clipY2))
         {
-            x = x0 + (16 + f_fontSpaceX) * k * ix;
-            y = y0;
-            character8 = (text16[k] == 0x20ac) ? 0x80 - ' ' : (text16[k] & 0xff) - ' ';
+            continue;
+        }
 
-            for (i = 0; i < 16; i++)
-            {
-                line = f_getCharacter(character8, 3 * i);
-                line1 = f_getCharacter(character8, 3 * i + 1);
-                line2 = f_getCharacter(character8, 3 * i + 2);
-                for (j = 0; j < 8; j++)
-                {
-                    if (bitRead(line, j))
-                    {
-                        dRectangle(x + i * ix, y0 + j * iy, ix, iy, textColour);
-                    }
-                    else if (f_fontSolid)
-                    {
-                        dRectangle(x + i * ix, y0 + j * iy, ix, iy, backColour);
-                    }
-                    if (bitRead(line1, j))
-                    {
-                        dRectangle(x + i * ix, y0 + (8 + j) * iy, ix, iy, textColour);
-                    }
-                    else if (f_fontSolid)
-                    {
-                        dRectangle(x + i * ix, y0 + (8 + j) * iy, ix, iy, backColour);
-                    }
-                    if (bitRead(line2, j))
-                    {
-                        dRectangle(x + i * ix, y0 + (16 + j) * iy, ix, iy, textColour);
-                    }
-                    else if (f_fontSolid)
-                    {
-                        dRectangle(x + i * ix, y0 + (16 + j) * iy, ix, iy, backColour);
-                    }
-                }
-            }
+        // Pen and font of the command
+        setPenSolid(item[0] & 0x0100);
+        setFontSolid(item[0] & 0x0200);
+        if (item[2] != f_fontIndex)
+        {
+            selectFont(item[2]);
+        }
+        f_fontSpaceX = item[3] & 0xff;
+        f_fontSpaceY = item[3] >> 8;
+
+        if (((item[0] & 0xff) == LIST_CLEAR) and flagRegion)
+        {
+            // Only the region cleared
+            setPenSolid(true);
+            rectangle(0, 0, screenSizeX() - 1, screenSizeY() - 1, item[LIST_HEADER]);
+        }
+        else
+        {
+            s_listDraw(item);
         }
+        count += 1;
+    }
+
+    if (flagRegion)
+    {
+        popClip();
     }
-#endif // end MAX_FONT_SIZE > 3
-#endif // end MAX_FONT_SIZE > 2
-#endif // end MAX_FONT_SIZE > 1
-#endif // end MAX_FONT_SIZE > 0
 
+    selectFont(oldFont);
+    setFontSolid(oldFontSolid);
+    f_fontSpaceX = oldSpaceX;
+    f_fontSpaceY = oldSpaceY;
     setPenSolid(oldPenSolid);
+    if (v_orientation != oldOrientation)
+    {
+        setOrientation(oldOrientation);
+    }
+
+    // Clip rectangles kept
+    v_clipX1 = oldClip[0];
+    v_clipY1 = oldClip[1];
+    v_clipX2 = oldClip[2];
+    v_clipY2 = oldClip[3];
+    v_clipDepth = oldClipDepth;
+
+    return count;
+}
+
+const uint16_t * hV_Screen_Buffer::getList(uint32_t & length)
+{
+    length = v_listLength;
+    return v_list;
+}
+
+void hV_Screen_Buffer::deleteList()
+{
+    if (v_listImmediate)
+    {
+        return;
+    }
+
+    delete[] v_list;
+    v_list = 0; // nullptr
+    v_listSize = 0;
+    v_listLength = 0;
+    v_listCount = 0;
+    v_listRecord = false;
+}
+
+void hV_Screen_Buffer::s_listRecord(uint8_t command, int32_t x1, int32_t y1, int32_t x2, int32_t y2, const uint16_t * values, uint8_t number)
+{
+    s_listBegin(command, x1, y1, x2, y2);
+    for (uint8_t i = 0; i < number; i++)
+    {
+        s_listAppend(values[i]);
+    }
+    s_listEnd();
+}
+
+void hV_Screen_Buffer::s_listBegin(uint8_t command, int32_t x1, int32_t y1, int32_t x2, int32_t y2)
+{
+    v_listStart = v_listLength;
+
+    s_listAppend(command | (v_penSolid ? 0x0100 : 0) | (f_fontSolid ? 0x0200 : 0));
+    s_listAppend(0); // number of words, set by s_listEnd()
+    s_listAppend(f_fontIndex);
+    s_listAppend(f_fontSpaceX | (f_fontSpaceY << 8));
+    s_listAppend(0);
+    s_listAppend(0);
+    s_listAppend(0);
+    s_listAppend(0);
+    s_listBox(x1, y1, x2, y2);
+}
+
+void hV_Screen_Buffer::s_listBox(int32_t x1, int32_t y1, int32_t x2, int32_t y2)
+{
+    if (v_listStart + LIST_HEADER > v_listSize)
+    {
+        return;
+    }
+
+    if (x1 > x2)
+    {
+        hV_HAL_swap(x1, x2);
+    }
+    if (y1 > y2)
+    {
+        hV_HAL_swap(y1, y2);
+    }
+
+    uint16_t * item = v_list + v_listStart;
+    item[4] = (int16_t)hV_HAL_min(hV_HAL_max(x1, (int32_t)INT16_MIN), (int32_t)INT16_MAX);
+    item[5] = (int16_t)hV_HAL_min(hV_HAL_max(y1, (int32_t)INT16_MIN), (int32_t)INT16_MAX);
+    item[6] = (int16_t)hV_HAL_min(hV_HAL_max(x2, (int32_t)INT16_MIN), (int32_t)INT16_MAX);
+    item[7] = (int16_t)hV_HAL_min(hV_HAL_max(y2, (int32_t)INT16_MIN), (int32_t)INT16_MAX);
+}
+
+void hV_Screen_Buffer::s_listAppend(uint16_t value)
+{
+    // Words beyond the size counted, command removed by s_listEnd()
+    if (v_listLength < v_listSize)
+    {
+        v_list[v_listLength] = value;
+    }
+    v_listLength += 1;
+}
+
+void hV_Screen_Buffer::s_listBitmap(uint16_t x0, uint16_t y0, const uint8_t * bitmap, uint16_t width, uint16_t height,
+                                    uint8_t format, const uint16_t * palette, bool flagTransparent, uint16_t transparent)
+{
+    uint16_t values[sizeof(bitmap) / 2];
+
+    s_listBegin(LIST_BITMAP, x0, y0, (int32_t)x0 + width - 1, (int32_t)y0 + height - 1);
+    s_listAppend(x0);
+    s_listAppend(y0);
+    s_listAppend(width);
+    s_listAppend(height);
+    s_listAppend(format);
+    s_listAppend(flagTransparent);
+    s_listAppend(transparent);
+    for (uint8_t i = 0; i < 4; i++)
+    {
+        s_listAppend(((palette != 0) and (i < (1 << format))) ? palette[i] : 0);
+    }
+
+    // Address of the bitmap, not its content
+    memcpy(values, &bitmap, sizeof(bitmap));
+    for (uint8_t i = 0; i < sizeof(bitmap) / 2; i++)
+    {
+        s_listAppend(values[i]);
+    }
+    s_listEnd();
+}
+
+uint32_t hV_Screen_Buffer::s_listText(TextIterator & iterator)
+{
+    uint32_t width = 0;
+
+#if (FONT_MODE == USE_FONT_TERMINAL)
+
+    uint16_t character;
+
+    while ((character = iterator.next()) != 0x0000)
+    {
+        s_listAppend(character);
+        width += f_getWidth(f_getGlyph(character)) + f_fontSpaceX;
+    }
 
 #endif // FONT_MODE
+
+    s_listAppend(0x0000);
+    return width;
+}
+
+void hV_Screen_Buffer::s_listEnd()
+{
+    // Command removed if list full or coordinates not in the list orientation
+    if ((v_listLength > v_listSize) or ((v_listImmediate == false) and (v_orientation != v_listOrientation)))
+    {
+        v_listLength = v_listStart;
+        v_listError = true;
+        if (v_listImmediate)
+        {
+            hV_HAL_log(LEVEL_ERROR, "Command too long");
+        }
+        return;
+    }
+
+    v_list[v_listStart + 1] = v_listLength - v_listStart;
+    v_listCount += 1;
+
+    if (v_listImmediate)
+    {
+        s_listCommand(v_list + v_listStart);
+        v_listLength = v_listStart;
+        v_listCount -= 1;
+    }
+}
+
+void hV_Screen_Buffer::s_listDraw(const uint16_t * item)
+{
+    const uint16_t * value = item + LIST_HEADER;
+
+    switch (item[0] & 0xff)
+    {
+        case LIST_CLEAR:
+
+            clear(value[0]);
+            break;
+
+        case LIST_POINT:
+
+            point(value[0], value[1], value[2]);
+            break;
+
+        case LIST_LINE:
+
+            line(value[0], value[1], value[2], value[3], value[4]);
+            break;
+
+        case LIST_RECTANGLE:
+
+            rectangle(value[0], value[1], value[2], value[3], value[4]);
+            break;
+
+        case LIST_CIRCLE:
+
+            circle(value[0], value[1], value[2], value[3]);
+            break;
+
+        case LIST_ELLIPSE:
+
+            ellipse(value[0], value[1], value[2], value[3], value[4]);
+            break;
+
+        case LIST_ROUNDED:
+
+            roundedRectangle(value[0], value[1], value[2], value[3], value[4], value[5]);
+            break;
+
+        case LIST_TRIANGLE:
+
+            triangle(value[0], value[1], value[2], value[3], value[4], value[5], value[6]);
+            break;
+
+        case LIST_POLYGON:
+
+            polygon(value + 3, value + 3 + value[2], value[2], value[0], value[1]);
+            break;
+
+        case LIST_BITMAP:
+        {
+            const uint8_t * bitmap;
+            memcpy(&bitmap, value + 11, sizeof(bitmap));
+            s_setBitmap(value[0], value[1], bitmap, value[2], value[3], value[4],
+                        (value[4] == BITMAP_RGB565) ? 0 : value + 7, value[5], value[6]);
+            break;
+        }
+
+        case LIST_TEXT:
+        {
+            TextIterator iterator(value + 4);
+            s_setText(value[0], value[1], iterator, value[2], value[3]);
+            break;
+        }
+
+        case LIST_TEXT_LARGE:
+        {
+            TextIterator iterator(value + 5);
+            s_setTextLarge(value[0], value[1], iterator, value[2], value[3], value[4] & 0xff, value[4] >> 8);
+            break;
+        }
+
+        case LIST_TEXT_BOX:
+        {
+            TextIterator iterator(value + 7);
+            s_textBox(value[0], value[1], value[2], value[3], iterator, value[4] & 0xff, value[4] >> 8, value[5], value[6]);
+            break;
+        }
+
+        default:
+
+            break;
+    }
 }
 //
-// === End of Font section
+// === End of Display list section
 //
-
@@ -43,7 +43,7 @@
 ///
 /// @brief Library release number
 ///
-#define hV_SCREEN_BUFFER_RELEASE 1001
+#define hV_SCREEN_BUFFER_RELEASE 1002
 
 // Colours
 #include "hV_Colours565.h"
@@ -66,6 +66,90 @@
 #error Required FONT_MODE == USE_FONT_TERMINAL
 #endif // FONT_MODE
 
+///
+/// @name Bitmap formats
+/// @{
+#define BITMAP_1BPP 1 ///< 1 bit per pixel, foreground and background colours
+#define BITMAP_2BPP 2 ///< 2 bits per pixel, palette of 4 colours
+#define BITMAP_RGB565 16 ///< 16 bits per pixel, RGB 5-6-5 colours
+/// @}
+
+///
+/// @brief No transparent index for indexed bitmaps
+///
+#define BITMAP_OPAQUE 0xff
+
+///
+/// @name Alignments for textBox()
+/// @{
+#define ALIGN_LEFT 0 ///< Text aligned on the left edge of the box
+#define ALIGN_CENTER 1 ///< Text centred in the box
+#define ALIGN_RIGHT 2 ///< Text aligned on the right edge of the box
+/// @}
+
+///
+/// @name Overflow policies for textBox()
+/// @{
+#define OVERFLOW_CLIP 0 ///< One line, characters beyond the box not drawn
+#define OVERFLOW_ELLIPSIS 1 ///< One line, last characters replaced by ...
+#define OVERFLOW_WRAP 2 ///< Lines wrapped on spaces, as many lines as the box fits
+/// @}
+
+///
+/// @name Fill rules for polygon()
+/// @{
+#define FILL_EVEN_ODD 0 ///< Inside if a ray crosses an odd number of edges
+#define FILL_NON_ZERO 1 ///< Inside if the edges crossed by a ray wind around the point
+/// @}
+
+///
+/// @brief Maximum number of nested clip rectangles for pushClip()
+///
+#define MAX_CLIP_DEPTH 8
+
+///
+/// @name Commands of the display list
+/// @details Each command is a header of LIST_HEADER words followed by its parameters
+/// * word 0: command, b8 = solid pen, b9 = solid font
+/// * word 1: number of words, header included
+/// * word 2: font, word 3: b7-b0 = space x-axis, b15-b8 = space y-axis
+/// * words 4 to 7: bounding box x1, y1, x2, y2, signed
+/// @{
+#define LIST_CLEAR 0x01 ///< colour
+#define LIST_POINT 0x02 ///< x1, y1, colour
+#define LIST_LINE 0x03 ///< x1, y1, x2, y2, colour
+#define LIST_RECTANGLE 0x04 ///< x1, y1, x2, y2, colour
+#define LIST_CIRCLE 0x05 ///< x0, y0, radius, colour
+#define LIST_ELLIPSE 0x06 ///< x0, y0, radiusX, radiusY, colour
+#define LIST_ROUNDED 0x07 ///< x1, y1, x2, y2, radius, colour
+#define LIST_TRIANGLE 0x08 ///< x1, y1, x2, y2, x3, y3, colour
+#define LIST_POLYGON 0x09 ///< colour, rule, number, x-axis coordinates, y-axis coordinates
+#define LIST_BITMAP 0x0a ///< x0, y0, width, height, format, flagTransparent, transparent, 4 palette colours, address
+#define LIST_TEXT 0x0b ///< x0, y0, textColour, backColour, UTF-16 characters, 0x0000
+#define LIST_TEXT_LARGE 0x0c ///< x0, y0, textColour, backColour, b7-b0 = scaleX, b15-b8 = scaleY, UTF-16 characters, 0x0000
+#define LIST_TEXT_BOX 0x0d ///< x0, y0, dx, dy, b7-b0 = alignment, b15-b8 = overflow, textColour, backColour, UTF-16 characters, 0x0000
+#define LIST_HEADER 8 ///< words of the header
+/// @}
+
+///
+/// @brief Edge of polygon
+/// @details Row by row, x-axis stepped by half rows and rounded to nearest
+///
+struct polygonEdge_s
+{
+    int16_t yTop; ///< first row
+    int16_t yBottom; ///< last row
+    int8_t direction; ///< +1 downwards, -1 upwards, 0 horizontal
+    int32_t x; ///< x-axis at the centre of the current row, first pixel if horizontal
+    int32_t xTop; ///< x-axis at the top of the current row, last pixel if horizontal
+    int32_t remainder; ///< fractional part of x, 0..denominator-1
+    int32_t step; ///< integer part of the step per half row
+    int32_t stepRemainder; ///< fractional part of the step, 0..denominator-1
+    int32_t denominator; ///< 2 * (yBottom - yTop)
+    int32_t xLeft; ///< first pixel of the edge on the current row
+    int32_t xRight; ///< last pixel of the edge on the current row
+};
+
 ///
 /// @brief Generic buffered screen class
 /// @details This class provides the text and graphic primitives for the buffered screen
@@ -82,6 +166,12 @@ class hV_Screen_Buffer : protected hV_Font_Terminal
     ///
     hV_Screen_Buffer();
 
+    ///
+    /// @brief Destructor
+    /// @note Polygon scratch released
+    ///
+    virtual ~hV_Screen_Buffer();
+
     /// @name General
     /// @{
 
@@ -118,6 +208,7 @@ class hV_Screen_Buffer : protected hV_Font_Terminal
     /// * ORIENTATION_LANDSCAPE = `7` = check landscape
     ///
     /// @note Run the Common_Orientation.ino example to identify the options
+    /// @note Clip rectangles removed
     ///
     virtual void setOrientation(uint8_t orientation);
 
@@ -164,6 +255,25 @@ class hV_Screen_Buffer : protected hV_Font_Terminal
     ///
     virtual uint8_t screenColourBits();
 
+    ///
+    /// @brief Restrict drawing to a rectangle
+    /// @param x0 top left coordinate, x-axis
+    /// @param y0 top left coordinate, y-axis
+    /// @param dx width
+    /// @param dy height
+    /// @return `RESULT_SUCCESS` = false = success, `RESULT_ERROR` = true = error, more than MAX_CLIP_DEPTH rectangles
+    /// @note Graphics and text clipped to the intersection of the rectangles pushed
+    /// @note clear(), copyArea() and scroll() not clipped
+    /// @note Coordinates of the current orientation
+    ///
+    bool pushClip(uint16_t x0, uint16_t y0, uint16_t dx, uint16_t dy);
+
+    ///
+    /// @brief Restore the clip rectangle before the last pushClip()
+    /// @return `RESULT_SUCCESS` = false = success, `RESULT_ERROR` = true = error, no rectangle pushed
+    ///
+    bool popClip();
+
     /// @}
 
     /// @name Graphics
@@ -181,6 +291,46 @@ class hV_Screen_Buffer : protected hV_Font_Terminal
     ///
     virtual void circle(uint16_t x0, uint16_t y0, uint16_t radius, uint16_t colour);
 
+    ///
+    /// @brief Draw ellipse
+    /// @param x0 center, point coordinate, x-axis
+    /// @param y0 center, point coordinate, y-axis
+    /// @param radiusX radius, x-axis
+    /// @param radiusY radius, y-axis
+    /// @param colour 16-bit colour
+    /// @note Solid ellipse filled with one span per row, outline with each pixel once
+    ///
+    /// @n @b More: @ref Coordinate, @ref Colour
+    ///
+    virtual void ellipse(uint16_t x0, uint16_t y0, uint16_t radiusX, uint16_t radiusY, uint16_t colour);
+
+    ///
+    /// @brief Draw rounded rectangle, rectangle coordinates
+    /// @param x1 top left coordinate, x-axis
+    /// @param y1 top left coordinate, y-axis
+    /// @param x2 bottom right coordinate, x-axis
+    /// @param y2 bottom right coordinate, y-axis
+    /// @param radius radius of the corners, up to half the shorter side
+    /// @param colour 16-bit colour
+    /// @note Solid rectangle filled with one span per row, outline with each pixel once
+    ///
+    /// @n @b More: @ref Coordinate, @ref Colour
+    ///
+    virtual void roundedRectangle(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2, uint16_t radius, uint16_t colour);
+
+    ///
+    /// @brief Draw rounded rectangle, vector coordinates
+    /// @param x0 point coordinate, x-axis
+    /// @param y0 point coordinate, y-axis
+    /// @param dx length, x-axis
+    /// @param dy height, y-axis
+    /// @param radius radius of the corners, up to half the shorter side
+    /// @param colour 16-bit colour
+    ///
+    /// @n @b More: @ref Coordinate, @ref Colour
+    ///
+    virtual void dRoundedRectangle(uint16_t x0, uint16_t y0, uint16_t dx, uint16_t dy, uint16_t radius, uint16_t colour);
+
     ///
     /// @brief Draw line, rectangle coordinates
     /// @param x1 top left coordinate, x-axis
@@ -188,6 +338,7 @@ class hV_Screen_Buffer : protected hV_Font_Terminal
     /// @param x2 bottom right coordinate, x-axis
     /// @param y2 bottom right coordinate, y-axis
     /// @param colour 16-bit colour
+    /// @note Clipped once to the screen, coordinates above 0x7fff considered negative
     ///
     /// @n @b More: @ref Coordinate, @ref Colour
     ///
@@ -211,6 +362,12 @@ class hV_Screen_Buffer : protected hV_Font_Terminal
     ///
     virtual void setPenSolid(bool flag = true);
 
+    ///
+    /// @brief Get pen opaque
+    /// @return `true` = opaque = solid, `false` = wire frame
+    ///
+    virtual bool getPenSolid();
+
     ///
     /// @brief Draw triangle, rectangle coordinates
     /// @param x1 first point coordinate, x-axis
@@ -226,6 +383,21 @@ class hV_Screen_Buffer : protected hV_Font_Terminal
     ///
     virtual void triangle(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2, uint16_t x3, uint16_t y3, uint16_t colour);
 
+    ///
+    /// @brief Draw polygon
+    /// @param x array of point coordinates, x-axis
+    /// @param y array of point coordinates, y-axis
+    /// @param number number of points, last point joined to first point
+    /// @param colour 16-bit colour
+    /// @param rule `FILL_EVEN_ODD` or `FILL_NON_ZERO`, default = `FILL_EVEN_ODD`
+    /// @note Convex or concave, solid polygon filled with one span per row
+    /// @note Solid polygon includes its edges
+    /// @note Rows clipped once to the screen, coordinates above 0x7fff considered negative
+    ///
+    /// @n @b More: @ref Coordinate, @ref Colour
+    ///
+    virtual void polygon(const uint16_t * x, const uint16_t * y, uint8_t number, uint16_t colour, uint8_t rule = FILL_EVEN_ODD);
+
     ///
     /// @brief Draw rectangle, rectangle coordinates
     /// @param x1 top left coordinate, x-axis
@@ -260,6 +432,64 @@ class hV_Screen_Buffer : protected hV_Font_Terminal
     ///
     virtual void point(uint16_t x1, uint16_t y1, uint16_t colour);
 
+    ///
+    /// @brief Read pixel colour
+    /// @param x1 point coordinate, x-axis
+    /// @param y1 point coordinate, y-axis
+    /// @return 16-bit colour, one of the colours of the screen
+    /// @note Read from the frame-buffer
+    ///
+    /// @n @b More: @ref Coordinate, @ref Colour
+    ///
+    virtual uint16_t readPixel(uint16_t x1, uint16_t y1);
+
+    ///
+    /// @brief Draw 1-bit bitmap
+    /// @param x0 top left coordinate, x-axis
+    /// @param y0 top left coordinate, y-axis
+    /// @param bitmap rows of 1-bit pixels, most significant bit first, each row padded to a full byte
+    /// @param width size of the bitmap, x-axis
+    /// @param height size of the bitmap, y-axis
+    /// @param colour 16-bit colour for bits set, default = black
+    /// @param backColour 16-bit colour for bits cleared, default = white
+    /// @param flagTransparent default = false, true = bits cleared not drawn
+    ///
+    /// @n @b More: @ref Coordinate, @ref Colour
+    ///
+    virtual void drawBitmap(uint16_t x0, uint16_t y0, const uint8_t * bitmap, uint16_t width, uint16_t height,
+                            uint16_t colour = myColours.black, uint16_t backColour = myColours.white, bool flagTransparent = false);
+
+    ///
+    /// @brief Draw 2-bit indexed bitmap
+    /// @param x0 top left coordinate, x-axis
+    /// @param y0 top left coordinate, y-axis
+    /// @param bitmap rows of 2-bit indexes, most significant bits first, each row padded to a full byte
+    /// @param width size of the bitmap, x-axis
+    /// @param height size of the bitmap, y-axis
+    /// @param palette 4 16-bit colours
+    /// @param transparentIndex index not drawn, default = `BITMAP_OPAQUE` = all indexes drawn
+    ///
+    /// @n @b More: @ref Coordinate, @ref Colour
+    ///
+    virtual void drawBitmap(uint16_t x0, uint16_t y0, const uint8_t * bitmap, uint16_t width, uint16_t height,
+                            const uint16_t * palette, uint8_t transparentIndex = BITMAP_OPAQUE);
+
+    ///
+    /// @brief Draw 16-bit colour bitmap
+    /// @param x0 top left coordinate, x-axis
+    /// @param y0 top left coordinate, y-axis
+    /// @param bitmap rows of 16-bit colours
+    /// @param width size of the bitmap, x-axis
+    /// @param height size of the bitmap, y-axis
+    /// @param flagTransparent default = false, true = transparentColour not drawn
+    /// @param transparentColour 16-bit colour not drawn, default = magenta
+    /// @note Colours not supported by the screen require setDither()
+    ///
+    /// @n @b More: @ref Coordinate, @ref Colour
+    ///
+    virtual void drawBitmap(uint16_t x0, uint16_t y0, const uint16_t * bitmap, uint16_t width, uint16_t height,
+                            bool flagTransparent = false, uint16_t transparentColour = myColours.magenta);
+
     /// @}
 
     /// @name Text
@@ -293,6 +523,12 @@ class hV_Screen_Buffer : protected hV_Font_Terminal
     ///
     virtual void setFontSolid(bool flag = true);
 
+    ///
+    /// @brief Get transparent or opaque text
+    /// @return `true` = opaque = solid, `false` = transparent
+    ///
+    virtual bool getFontSolid();
+
     ///
     /// @brief Set additional spaces between two characters, horizontal axis
     /// @param number of spaces default = 1 pixel
@@ -415,6 +651,9 @@ class hV_Screen_Buffer : protected hV_Font_Terminal
     /// @param text UTF-8 coded text (uint8_t)
     /// @param textColour 16-bit colour, default = white
     /// @param backColour 16-bit colour, default = black
+    /// @param scaleX scale for x-axis, default = 2, 2..8
+    /// @param scaleY scale for y-axis, default = 0 = same as scaleX, 2..8
+    /// @note Runs of identical pixels in a column and identical columns filled as one rectangle
     /// @warning UTF-8 coded text is required
     /// @deprecated ISO-8859-1 or Latin 1 coded text is deprecated, use UTF-8 coded text instead (10.0.0)
     ///
@@ -423,12 +662,90 @@ class hV_Screen_Buffer : protected hV_Font_Terminal
     virtual void gTextLarge(uint16_t x0, uint16_t y0,
                             STRING_CONST_TYPE text,
                             uint16_t textColour = myColours.black,
-                            uint16_t backColour = myColours.white);
+                            uint16_t backColour = myColours.white,
+                            uint8_t scaleX = 2, uint8_t scaleY = 0);
 
     virtual void gTextLarge(uint16_t x0, uint16_t y0,
                             STRING16_CONST_TYPE text,
                             uint16_t textColour = myColours.black,
-                            uint16_t backColour = myColours.white);
+                            uint16_t backColour = myColours.white,
+                            uint8_t scaleX = 2, uint8_t scaleY = 0);
+
+    ///
+    /// @brief Draw UTF-8 coded text in a box (vector coordinates)
+    /// @param x0 top left coordinate, x-axis
+    /// @param y0 top left coordinate, y-axis
+    /// @param dx width, x-axis
+    /// @param dy height, y-axis
+    /// @param text UTF-8 coded text
+    /// @param alignment `ALIGN_LEFT`, `ALIGN_CENTER` or `ALIGN_RIGHT`, default = `ALIGN_LEFT`
+    /// @param overflow `OVERFLOW_CLIP`, `OVERFLOW_ELLIPSIS` or `OVERFLOW_WRAP`, default = `OVERFLOW_CLIP`
+    /// @param textColour 16-bit colour, default = black
+    /// @param backColour 16-bit colour, default = white
+    /// @return number of characters drawn
+    /// @note Text measured, cut, aligned and drawn in one pass, with look-ahead of one line
+    /// @note One line centred vertically, wrapped lines from the top, new line with `\n` when wrapped
+    /// @note Background filled around the characters, characters drawn with solid font
+    ///
+    /// @n @b More: @ref Colour, @ref Fonts, @ref Coordinate
+    ///
+    virtual uint16_t textBox(uint16_t x0, uint16_t y0, uint16_t dx, uint16_t dy,
+                             STRING_CONST_TYPE text,
+                             uint8_t alignment = ALIGN_LEFT, uint8_t overflow = OVERFLOW_CLIP,
+                             uint16_t textColour = myColours.black,
+                             uint16_t backColour = myColours.white);
+    /// @}
+
+    /// @name Display list
+    ///
+    /// @{
+
+    ///
+    /// @brief Start recording the display list
+    /// @param size size of the list, in bytes
+    /// @return `RESULT_SUCCESS` = false = success, `RESULT_ERROR` = true = error, list not created
+    /// @note Graphics, text and clear() recorded and not drawn, until replayList()
+    /// @note Previous commands discarded, list created again only if size differs
+    /// @note Commands recorded with pen, font and orientation of beginList()
+    /// @note Not available when the frame-buffer is in external memory
+    /// @note Text copied into the list, bitmaps recorded by address
+    /// @note Clip rectangles and operations on areas not recorded
+    /// @see LIST_CLEAR and following for the format
+    ///
+    bool beginList(uint32_t size);
+
+    ///
+    /// @brief Stop recording the display list
+    /// @return `RESULT_SUCCESS` = false = success, `RESULT_ERROR` = true = error, commands lost as list full or orientation changed
+    ///
+    bool endList();
+
+    ///
+    /// @brief Draw the commands of the display list intersecting a region
+    /// @param x0 top left coordinate of the region, x-axis
+    /// @param y0 top left coordinate of the region, y-axis
+    /// @param dx width of the region, default = 0 = whole screen
+    /// @param dy height of the region, default = 0 = whole screen
+    /// @return number of commands drawn
+    /// @note Commands with a bounding box outside the region or the clip rectangle skipped, others clipped to the region
+    /// @note Region in the orientation of the list, pen and font restored after
+    /// @note clear() replayed in a region as a solid rectangle, patterns of grey or substituted colours may differ
+    /// @warning Not while recording
+    ///
+    uint16_t replayList(uint16_t x0 = 0, uint16_t y0 = 0, uint16_t dx = 0, uint16_t dy = 0);
+
+    ///
+    /// @brief Get the display list for inspection
+    /// @param[out] length number of words used
+    /// @return first word of the list, nullptr if none
+    ///
+    const uint16_t * getList(uint32_t & length);
+
+    ///
+    /// @brief Release the display list
+    ///
+    void deleteList();
+
     /// @}
 
     //
@@ -507,36 +824,315 @@ class hV_Screen_Buffer : protected hV_Font_Terminal
     /// @param x1 x coordinate
     /// @param y1 y coordinate
     /// @param colour 16-bit colour
+    /// @note Point outside the clip rectangle ignored
     /// @n @b More: @ref Colour, @ref Coordinate
     ///
     virtual void s_setPoint(uint16_t x1, uint16_t y1, uint16_t colour) = 0; // compulsory
 
+    ///
+    /// @brief Set point already clipped
+    /// @param x1 x coordinate, within clip rectangle
+    /// @param y1 y coordinate, within clip rectangle
+    /// @param colour 16-bit colour
+    /// @note Default with s_setPoint(), optimised by the screen without check
+    /// @n @b More: @ref Colour, @ref Coordinate
+    ///
+    virtual void s_setPointInside(uint16_t x1, uint16_t y1, uint16_t colour);
+
+    ///
+    /// @brief Get point
+    /// @param x1 x coordinate
+    /// @param y1 y coordinate
+    /// @return 16-bit colour
+    /// @n @b More: @ref Colour, @ref Coordinate
+    ///
+    virtual uint16_t s_getPoint(uint16_t x1, uint16_t y1) = 0; // compulsory
+
+    ///
+    /// @brief Set span, x-axis
+    /// @param x1 first point coordinate, x-axis
+    /// @param x2 last point coordinate, x-axis
+    /// @param y1 point coordinate, y-axis
+    /// @param colour 16-bit colour
+    /// @note Default with s_setPoint(), optimised by the screen
+    /// @n @b More: @ref Colour, @ref Coordinate
+    ///
+    virtual void s_setSpanX(uint16_t x1, uint16_t x2, uint16_t y1, uint16_t colour);
+
+    ///
+    /// @brief Set span, y-axis
+    /// @param x1 point coordinate, x-axis
+    /// @param y1 first point coordinate, y-axis
+    /// @param y2 last point coordinate, y-axis
+    /// @param colour 16-bit colour
+    /// @note Default with s_setPoint(), optimised by the screen
+    /// @n @b More: @ref Colour, @ref Coordinate
+    ///
+    virtual void s_setSpanY(uint16_t x1, uint16_t y1, uint16_t y2, uint16_t colour);
+
+    ///
+    /// @brief Set solid rectangle
+    /// @param x1 top left coordinate, x-axis
+    /// @param y1 top left coordinate, y-axis
+    /// @param x2 bottom right coordinate, x-axis
+    /// @param y2 bottom right coordinate, y-axis
+    /// @param colour 16-bit colour
+    /// @note Default with s_setSpanX(), optimised by the screen
+    /// @n @b More: @ref Colour, @ref Coordinate
+    ///
+    virtual void s_setRectangle(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2, uint16_t colour);
+
+    ///
+    /// @brief Set bitmap
+    /// @param x0 top left coordinate, x-axis
+    /// @param y0 top left coordinate, y-axis
+    /// @param bitmap rows of pixels, each row padded to a full byte
+    /// @param width size of the bitmap, x-axis
+    /// @param height size of the bitmap, y-axis
+    /// @param format `BITMAP_1BPP`, `BITMAP_2BPP` or `BITMAP_RGB565`
+    /// @param palette colours for indexes, `BITMAP_1BPP` and `BITMAP_2BPP` only
+    /// @param flagTransparent true = transparent index or colour not drawn
+    /// @param transparent index for `BITMAP_1BPP` and `BITMAP_2BPP`, colour for `BITMAP_RGB565`
+    /// @note Default with s_setPoint(), optimised by the screen
+    /// @n @b More: @ref Colour, @ref Coordinate
+    ///
+    virtual void s_setBitmap(uint16_t x0, uint16_t y0, const uint8_t * bitmap, uint16_t width, uint16_t height,
+                             uint8_t format, const uint16_t * palette, bool flagTransparent, uint16_t transparent);
+
+    ///
+    /// @brief Get colour of a bitmap pixel
+    /// @param row first byte of the row
+    /// @param index pixel index in the row
+    /// @param format `BITMAP_1BPP`, `BITMAP_2BPP` or `BITMAP_RGB565`
+    /// @param palette colours for indexes
+    /// @param flagTransparent true = transparent index or colour not drawn
+    /// @param transparent index or colour
+    /// @param[out] colour 16-bit colour
+    /// @return true if the pixel is drawn, false if transparent
+    ///
+    bool s_getBitmapColour(const uint8_t * row, uint16_t index, uint8_t format, const uint16_t * palette, bool flagTransparent, uint16_t transparent, uint16_t & colour);
+
+    ///
+    /// @brief Set text
+    /// @param x0 top left coordinate, x-axis
+    /// @param y0 top left coordinate, y-axis
+    /// @param iterator iterator on UTF-8 or UTF-16 coded text
+    /// @param textColour 16-bit colour for text
+    /// @param backColour 16-bit colour for background, only with solid font
+    /// @note Characters decoded and drawn one by one, no buffer
+    ///
+    void s_setText(uint16_t x0, uint16_t y0, TextIterator & iterator, uint16_t textColour, uint16_t backColour);
+
+    ///
+    /// @brief Set large text
+    /// @param x0 top left coordinate, x-axis
+    /// @param y0 top left coordinate, y-axis
+    /// @param iterator iterator on UTF-8 or UTF-16 coded text
+    /// @param textColour 16-bit colour for text
+    /// @param backColour 16-bit colour for background, only with solid font
+    /// @param scaleX scale for x-axis, 2..8
+    /// @param scaleY scale for y-axis, 0 = same as scaleX, 2..8
+    ///
+    void s_setTextLarge(uint16_t x0, uint16_t y0, TextIterator & iterator,
+                        uint16_t textColour, uint16_t backColour,
+                        uint8_t scaleX, uint8_t scaleY);
+
+    ///
+    /// @brief Set text in a box
+    /// @param x0 top left coordinate, x-axis
+    /// @param y0 top left coordinate, y-axis
+    /// @param dx width, x-axis
+    /// @param dy height, y-axis
+    /// @param iterator iterator on UTF-8 or UTF-16 coded text
+    /// @param alignment `ALIGN_LEFT`, `ALIGN_CENTER` or `ALIGN_RIGHT`
+    /// @param overflow `OVERFLOW_CLIP`, `OVERFLOW_ELLIPSIS` or `OVERFLOW_WRAP`
+    /// @param textColour 16-bit colour for text
+    /// @param backColour 16-bit colour for background
+    /// @return number of characters drawn
+    ///
+    uint16_t s_textBox(uint16_t x0, uint16_t y0, uint16_t dx, uint16_t dy, TextIterator & iterator,
+                       uint8_t alignment, uint8_t overflow, uint16_t textColour, uint16_t backColour);
+
+    ///
+    /// @brief Set character
+    /// @param x0 top left coordinate, x-axis
+    /// @param y0 top left coordinate, y-axis
+    /// @param glyph index of the glyph in the font, from f_getGlyph()
+    /// @param textColour 16-bit colour for text
+    /// @param backColour 16-bit colour for background, only with solid font
+    /// @note Default with point(), optimised by the screen
+    /// @n @b More: @ref Colour, @ref Coordinate
+    ///
+    virtual void s_setCharacter(uint16_t x0, uint16_t y0, uint16_t glyph, uint16_t textColour, uint16_t backColour);
+
     // Touch
     virtual void s_getRawTouch(touch_t & touch); // compulsory
     virtual bool s_getInterruptTouch(); // compulsory
 
     // Other functions
-    // required by triangle()
+    // required by triangle() and polygon()
     ///
-    /// @brief Triangle utility
-    /// @param x1 first point coordinate, x-axis
-    /// @param y1 first point coordinate, y-axis
-    /// @param x2 second point coordinate, x-axis
-    /// @param y2 second point coordinate, y-axis
-    /// @param x3 third point coordinate, x-axis
-    /// @param y3 third point coordinate, y-axis
+    /// @brief Polygon utility
+    /// @param x array of point coordinates, x-axis
+    /// @param y array of point coordinates, y-axis
+    /// @param number number of points
     /// @param colour 16-bit colour
+    /// @param rule `FILL_EVEN_ODD` or `FILL_NON_ZERO`
+    /// @note Edge table scanned row by row, spans of the row merged and written once
+    /// @note Scratch for the edges kept between calls, grown for a polygon with more points
+    /// @note Span from the first pixel of the left edge to the last pixel of the right edge
     ///
-    void s_triangleArea(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2, uint16_t x3, uint16_t y3, uint16_t colour);
+    void s_polygonArea(const uint16_t * x, const uint16_t * y, uint8_t number, uint16_t colour, uint8_t rule);
+
+    // required by circle(), ellipse() and roundedRectangle()
+    ///
+    /// @brief Set the two rows of a circle
+    /// @param x0 center, point coordinate, x-axis
+    /// @param y0 center, point coordinate, y-axis
+    /// @param dy rows y0 - dy and y0 + dy, one row if 0
+    /// @param dx half-width of the rows
+    /// @param colour 16-bit colour
+    ///
+    void s_setCircleRows(uint16_t x0, uint16_t y0, uint16_t dy, uint16_t dx, uint16_t colour);
+
+    ///
+    /// @brief Rounded area utility
+    /// @param x1 top left coordinate, x-axis, may be negative
+    /// @param y1 top left coordinate, y-axis, may be negative
+    /// @param x2 bottom right coordinate, x-axis
+    /// @param y2 bottom right coordinate, y-axis
+    /// @param radiusX radius of the corners, x-axis, up to half the width
+    /// @param radiusY radius of the corners, y-axis, up to half the height
+    /// @param colour 16-bit colour
+    /// @note Ellipse when the radii are half the sides
+    /// @note Solid with one span per row, outline with each pixel once
+    ///
+    void s_roundedArea(int32_t x1, int32_t y1, int32_t x2, int32_t y2, uint16_t radiusX, uint16_t radiusY, uint16_t colour);
+
+    ///
+    /// @brief Set solid area clipped to the clip rectangle
+    /// @param x1 first corner coordinate, x-axis, may be negative
+    /// @param y1 first corner coordinate, y-axis, may be negative
+    /// @param x2 opposite corner coordinate, x-axis, may be negative
+    /// @param y2 opposite corner coordinate, y-axis, may be negative
+    /// @param colour 16-bit colour
+    /// @note With s_setSpanX() for a row, s_setSpanY() for a column, s_setRectangle() otherwise
+    ///
+    void s_setClippedArea(int32_t x1, int32_t y1, int32_t x2, int32_t y2, uint16_t colour);
+
+    ///
+    /// @brief Clip area to the clip rectangle
+    /// @param[out] x1 first corner coordinate, x-axis, sorted
+    /// @param[out] y1 first corner coordinate, y-axis, sorted
+    /// @param[out] x2 opposite corner coordinate, x-axis, sorted
+    /// @param[out] y2 opposite corner coordinate, y-axis, sorted
+    /// @return `RESULT_SUCCESS` = false = success, `RESULT_ERROR` = true = error, empty area
+    ///
+    bool s_clipArea(uint16_t & x1, uint16_t & y1, uint16_t & x2, uint16_t & y2);
+
+    ///
+    /// @brief Reset the clip rectangle to the screen and empty the stack
+    /// @note Called by setOrientation()
+    ///
+    virtual void s_resetClip();
+
+    ///
+    /// @brief Record a command with its parameters
+    /// @param command command, LIST_CLEAR and following
+    /// @param x1 bounding box, top left coordinate, x-axis
+    /// @param y1 bounding box, top left coordinate, y-axis
+    /// @param x2 bounding box, bottom right coordinate, x-axis
+    /// @param y2 bounding box, bottom right coordinate, y-axis
+    /// @param values parameters
+    /// @param number number of parameters
+    ///
+    void s_listRecord(uint8_t command, int32_t x1, int32_t y1, int32_t x2, int32_t y2, const uint16_t * values, uint8_t number);
+
+    ///
+    /// @brief Start a command, header with pen, font and bounding box
+    /// @param command command, LIST_CLEAR and following
+    /// @param x1 bounding box, top left coordinate, x-axis
+    /// @param y1 bounding box, top left coordinate, y-axis
+    /// @param x2 bounding box, bottom right coordinate, x-axis
+    /// @param y2 bounding box, bottom right coordinate, y-axis
+    /// @note Bounding box updated later with s_listBox() if required
+    ///
+    void s_listBegin(uint8_t command, int32_t x1, int32_t y1, int32_t x2, int32_t y2);
+
+    ///
+    /// @brief Update the bounding box of the current command
+    /// @param x1 top left coordinate, x-axis
+    /// @param y1 top left coordinate, y-axis
+    /// @param x2 bottom right coordinate, x-axis
+    /// @param y2 bottom right coordinate, y-axis
+    ///
+    void s_listBox(int32_t x1, int32_t y1, int32_t x2, int32_t y2);
+
+    ///
+    /// @brief Append one word to the current command
+    /// @param value word
+    /// @note Words beyond the size of the list counted but not written
+    ///
+    void s_listAppend(uint16_t value);
+
+    ///
+    /// @brief Record a bitmap
+    /// @param x0 top left coordinate, x-axis
+    /// @param y0 top left coordinate, y-axis
+    /// @param bitmap address of the bitmap, kept until replay
+    /// @param width width of the bitmap
+    /// @param height height of the bitmap
+    /// @param format `BITMAP_1BPP`, `BITMAP_2BPP` or `BITMAP_RGB565`
+    /// @param palette palette of 2 or 4 colours, copied, nullptr for `BITMAP_RGB565`
+    /// @param flagTransparent true to skip transparent pixels
+    /// @param transparent transparent index or colour
+    ///
+    void s_listBitmap(uint16_t x0, uint16_t y0, const uint8_t * bitmap, uint16_t width, uint16_t height,
+                      uint8_t format, const uint16_t * palette, bool flagTransparent, uint16_t transparent);
+
+    ///
+    /// @brief Append a text to the current command
+    /// @param iterator iterator on UTF-8 or UTF-16 coded text
+    /// @return width of the text in pixels, with current font
+    ///
+    uint32_t s_listText(TextIterator & iterator);
+
+    ///
+    /// @brief Close the current command
+    /// @note Command removed and list marked with error if list full or orientation changed
+    ///
+    void s_listEnd();
+
+    ///
+    /// @brief Draw one command of the display list
+    /// @param item first word of the command
+    ///
+    void s_listDraw(const uint16_t * item);
+
+    ///
+    /// @brief Process a command recorded in immediate mode
+    /// @param item first word of the command
+    /// @note Called by s_listEnd() when v_listImmediate, command removed after
+    /// @warning Definition for this method is compulsory.
+    ///
+    virtual void s_listCommand(const uint16_t * item) = 0;
 
     // required by gText()
     ///
     /// @brief Get definition for line of character
-    /// @param character character 32~255
-    /// @param index column index
+    /// @param glyph index of the glyph in the font
+    /// @param index byte index
     /// @return definition for line of character
     ///
-    uint8_t s_getCharacter(uint8_t character, uint8_t index);
+    uint8_t s_getCharacter(uint16_t glyph, uint8_t index);
+
+    ///
+    /// @brief Get column of character
+    /// @param glyph index of the glyph in the font
+    /// @param index column index
+    /// @return pixels of the column, bit j for row j, up to 32 rows
+    ///
+    uint32_t s_getColumn(uint16_t glyph, uint8_t index);
 
     // Frame-buffer
     FRAMEBUFFER_TYPE s_newImage;
@@ -553,6 +1149,22 @@ class hV_Screen_Buffer : protected hV_Font_Terminal
     uint8_t v_touchTrim = 0x00; // no touch
     bool v_touchEvent = false; // no touch event
     uint16_t v_touchXmin, v_touchXmax, v_touchYmin, v_touchYmax;
+    uint16_t v_clipX1, v_clipY1, v_clipX2, v_clipY2; // current clip rectangle, within screen
+    uint16_t v_clipStack[MAX_CLIP_DEPTH][4]; // previous clip rectangles
+    uint8_t v_clipDepth = 0; // no clip
+    uint16_t * v_list = 0; // display list, nullptr if none
+    uint32_t v_listSize = 0; // words
+    uint32_t v_listLength = 0; // words used
+    uint32_t v_listStart = 0; // first word of the current command
+    uint16_t v_listCount = 0; // commands
+    uint8_t v_listOrientation = 0;
+    bool v_listRecord = false;
+    bool v_listError = false;
+    bool v_listImmediate = false; // each command passed to s_listCommand(), any orientation
+    polygonEdge_s * v_polygonEdges = 0; // polygon scratch, nullptr if none
+    uint8_t * v_polygonActive = 0; // active edges, nullptr if none
+    uint32_t * v_polygonBuffer = 0; // crossings and spans, nullptr if none
+    uint8_t v_polygonSize = 0; // points of the scratch
 
     /// @endcond
 };